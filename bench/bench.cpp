@@ -0,0 +1,344 @@
+// bench.cpp - Scheduler kernel microbenchmarks
+//
+// Stresses veroutines.h in isolation (null models, no DUT logic) plus one
+// end-to-end axibox run with and without VCD. Built and run by `make bench`.
+//
+//   Vaxibox [filter] [--quick]
+//
+// Each case reports wall time, timesteps/sec and deltas/sec.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "verilated_vcd_c.h"
+#include "Vaxibox.h"
+#include "veroutines.h"
+#include "veroutines_regress.h"
+#include "veroutines_static.h"
+
+using namespace Veroutines;
+
+// ============================================================================
+// Harness
+// ============================================================================
+
+// Model with no logic: isolates kernel cost from eval()
+struct NullModel {
+    void eval() {}
+    bool eventsPending() const { return false; }
+    uint64_t nextTimeSlot() const { return 0; }
+};
+
+struct Result {
+    double seconds;
+    uint64_t timesteps;
+    uint64_t deltas;
+};
+
+static void report(const char* name, const std::string& params, const Result& r) {
+    std::printf("%-14s %-26s %9.2f ms %12.3e steps/s %12.3e deltas/s\n",
+                name, params.c_str(), r.seconds * 1e3,
+                r.seconds > 0 ? double(r.timesteps) / r.seconds : 0.0,
+                r.seconds > 0 ? double(r.deltas) / r.seconds : 0.0);
+}
+
+template<typename Setup>
+static Result measure(uint64_t sim_time, Setup&& setup) {
+    VerilatedContext ctx;
+    NullModel top;
+    Scheduler sched;
+    setup(sched);
+
+    auto t0 = std::chrono::steady_clock::now();
+    sched.run(&ctx, &top, static_cast<NoTrace*>(nullptr), sim_time);
+    auto t1 = std::chrono::steady_clock::now();
+
+    return {std::chrono::duration<double>(t1 - t0).count(), sched.timesteps(), sched.deltas()};
+}
+
+// ============================================================================
+// Cases
+// ============================================================================
+
+// N ports x M processes: one clock wakes every process, each writes a port
+static void bench_fanout(size_t ports, size_t procs, uint64_t sim_time) {
+    std::vector<CData> pins(ports + 1);
+    auto r = measure(sim_time, [&](Scheduler& s) {
+        auto clk = s.input(&pins[0]);
+        std::vector<InputPort<CData>*> out;
+        for (size_t i = 1; i <= ports; ++i) out.push_back(s.input(&pins[i]));
+        s.clock(clk, 2);
+        for (size_t p = 0; p < procs; ++p) {
+            auto* port = out[p % ports];
+            s.process({posedge(clk)}, [port](Scheduler&) { port->write(!port->val()); });
+        }
+    });
+    report("fanout", std::to_string(ports) + " ports x " + std::to_string(procs) + " procs", r);
+}
+
+// Signal chain: each rising clock edge ripples through `depth` deltas
+static void bench_delta_chain(size_t depth, uint64_t sim_time) {
+    CData clk_pin = 0;
+    auto r = measure(sim_time, [&](Scheduler& s) {
+        auto clk = s.input(&clk_pin);
+        std::vector<Signal<uint32_t>*> chain;
+        for (size_t i = 0; i <= depth; ++i) chain.push_back(s.signal<uint32_t>(0));
+        s.clock(clk, 2);
+        s.process({posedge(clk)}, [c = chain[0]](Scheduler&) { c->write(c->val() + 1); });
+        for (size_t i = 0; i < depth; ++i) {
+            auto* from = chain[i];
+            auto* to = chain[i + 1];
+            s.process({from}, [from, to](Scheduler&) { to->write(from->val()); });
+        }
+    });
+    report("delta_chain", "depth " + std::to_string(depth), r);
+}
+
+// delta_chain depth 4 on StaticScheduler: same work, topology fixed at compile time
+struct ClkModel : NullModel {
+    CData clk = 0;
+};
+
+using ChainClk = Static::In<VR_PORT(clk)>;
+template<int I> struct Stage : Static::Sig<uint32_t> {};
+
+struct ChainHead {
+    void operator()(auto& s) { auto& c = port<Stage<0>>(s); c.write(c.val() + 1); }
+};
+
+template<int I>
+struct ChainLink {
+    void operator()(auto& s) { port<Stage<I + 1>>(s).write(port<Stage<I>>(s).val()); }
+};
+
+static void bench_static_chain(uint64_t sim_time) {
+    using Chain = StaticScheduler<ClkModel,
+        Static::Ports<ChainClk, Stage<0>, Stage<1>, Stage<2>, Stage<3>, Stage<4>>,
+        Static::Processes<Static::Proc<ChainHead, Static::Pos<ChainClk>>,
+                          Static::Proc<ChainLink<0>, Stage<0>>,
+                          Static::Proc<ChainLink<1>, Stage<1>>,
+                          Static::Proc<ChainLink<2>, Stage<2>>,
+                          Static::Proc<ChainLink<3>, Stage<3>>>>;
+    VerilatedContext ctx;
+    ClkModel top;
+    Chain sched(&ctx, &top);
+    sched.clock<ChainClk>(2);
+
+    auto t0 = std::chrono::steady_clock::now();
+    sched.run(static_cast<NoTrace*>(nullptr), sim_time);
+    auto t1 = std::chrono::steady_clock::now();
+
+    report("static_chain", "depth 4",
+           {std::chrono::duration<double>(t1 - t0).count(), sched.timesteps(), sched.deltas()});
+}
+
+// Wide output fan-in: every output changes each cycle, one is watched
+struct CounterModel {
+    CData clk = 0;
+    CData last = 0;
+    CData in = 0;
+    CData comb = 0;              // Combinational copy of in
+    std::vector<IData> out;
+    void eval() {
+        if (clk && !last)
+            for (auto& o : out) ++o;
+        last = clk;
+        comb = in;
+    }
+    bool eventsPending() const { return false; }
+    uint64_t nextTimeSlot() const { return 0; }
+};
+
+// Returns a hash of the pre-edge values two processes read at every
+// rising edge; on-demand sampling must see the same ones as eager
+// sampling, also when the processes run on REACT workers
+static uint64_t bench_outputs(size_t outputs, bool on_demand, uint64_t sim_time,
+                              size_t react_threads = 1) {
+    VerilatedContext ctx;
+    CounterModel top;
+    top.out.resize(outputs);
+    Scheduler sched;
+    sched.sample_on_demand(on_demand);
+    sched.react_threads(react_threads);
+    auto clk = sched.input(&top.clk);
+    std::vector<OutputPort<IData>*> out;
+    for (auto& o : top.out) out.push_back(sched.output(&o));
+    sched.clock(clk, 2);
+    uint64_t sum = 0;
+    sched.process({out[0]}, [&](Scheduler&) { sum += out[0]->val(); });
+
+    auto in = sched.input(&top.in);
+    auto comb = sched.output(&top.comb);
+    uint64_t edges[2] = {};
+    sched.process({negedge(clk)}, [&](Scheduler&) { in->write(!in->val()); });
+    for (auto& e : edges)
+        sched.process({posedge(clk)}, [&](Scheduler&) { e = e * 31 + comb->before() + out[1]->before(); });
+
+    auto t0 = std::chrono::steady_clock::now();
+    sched.run(&ctx, &top, static_cast<NoTrace*>(nullptr), sim_time);
+    auto t1 = std::chrono::steady_clock::now();
+
+    report("outputs", std::to_string(outputs) + (on_demand ? " on demand" : " eager") +
+                          (react_threads > 1 ? ", " + std::to_string(react_threads) + " react threads" : ""),
+           {std::chrono::duration<double>(t1 - t0).count(), sched.timesteps(), sched.deltas()});
+    return edges[0] * 31 + edges[1];
+}
+
+// Asynchronous clock domains as self-rescheduling timed events
+static void bench_timed_clocks(size_t clocks, uint64_t sim_time) {
+    std::vector<CData> pins(clocks);
+    auto r = measure(sim_time, [&](Scheduler& s) {
+        for (size_t i = 0; i < clocks; ++i) {
+            auto* clk = s.input(&pins[i]);
+            uint64_t half = 3 + i % 7;
+            struct Toggle {
+                Scheduler* s;
+                InputPort<CData>* clk;
+                uint64_t half;
+                void operator()() const {
+                    clk->write(!clk->val());
+                    s->schedule_after(half, *this);
+                }
+            };
+            Toggle{&s, clk, half}();
+        }
+    });
+    report("timed_clocks", std::to_string(clocks) + " clocks", r);
+}
+
+// Same clock domains driven by the kernel-native generator
+static void bench_native_clocks(size_t clocks, uint64_t sim_time) {
+    std::vector<CData> pins(clocks);
+    auto r = measure(sim_time, [&](Scheduler& s) {
+        for (size_t i = 0; i < clocks; ++i)
+            s.clock(s.input(&pins[i]), 2 * (3 + i % 7));
+    });
+    report("native_clocks", std::to_string(clocks) + " clocks", r);
+}
+
+// End-to-end axibox (runs until its $finish), repeated, VCD on or off
+static void bench_axibox(bool vcd, int runs) {
+    Verilated::mkdir("logs");
+    Result total{0, 0, 0};
+    for (int i = 0; i < runs; ++i) {
+        VerilatedContext ctx;
+        ctx.traceEverOn(vcd);
+        Vaxibox top{&ctx, ""};
+        VerilatedVcdC tfp;
+        if (vcd && !open_trace(&top, &tfp, "logs/bench.vcd")) {
+            std::printf("axibox: trace not open\n");
+            return;
+        }
+
+        Scheduler sched;
+        auto clk = sched.input(&top.clk);
+        auto rst = sched.input(&top.rst);
+        auto s_tvalid = sched.input(&top.s_tvalid);
+        auto s_tdata = sched.input(&top.s_tdata);
+        auto m_tready = sched.input(&top.m_tready);
+        auto s_tready = sched.output(&top.s_tready);
+
+        sched.clock(clk, 10, 0.5, 5);
+        rst->write(1);
+        sched.schedule_at(20, [&] { rst->write(0); });
+        m_tready->write(1);
+        sched.process({posedge(clk)}, [&](Scheduler&) {
+            if (!rst->val() && s_tready->val()) {
+                s_tvalid->write(1);
+                s_tdata->write(s_tdata->val() + 1);
+            }
+        });
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (vcd) sched.run(&ctx, &top, &tfp);
+        else sched.run(&ctx, &top);
+        auto t1 = std::chrono::steady_clock::now();
+
+        top.final();
+        if (vcd) tfp.close();
+        total.seconds += std::chrono::duration<double>(t1 - t0).count();
+        total.timesteps += sched.timesteps();
+        total.deltas += sched.deltas();
+    }
+    report("axibox", std::string(vcd ? "vcd on" : "vcd off") + ", " + std::to_string(runs) + " runs",
+           total);
+}
+
+// The same axibox bench over many seeds on all cores, in one process
+static void bench_axibox_seeds(size_t seeds) {
+    auto summary = run_seeds<Vaxibox>(1, seeds, [](SeedRun<Vaxibox>& r) {
+        auto clk = r.sched.input(&r.top.clk);
+        auto rst = r.sched.input(&r.top.rst);
+        auto s_tvalid = r.sched.input(&r.top.s_tvalid);
+        auto s_tdata = r.sched.input(&r.top.s_tdata);
+        auto m_tready = r.sched.input(&r.top.m_tready);
+        auto s_tready = r.sched.output(&r.top.s_tready);
+
+        r.sched.clock(clk, 10, 0.5, 5);
+        rst->write(1);
+        r.sched.schedule_at(20, [rst] { rst->write(0); });
+        m_tready->write(1);
+        r.sched.process({posedge(clk)}, [=](Scheduler&) {
+            if (!rst->val() && s_tready->val()) {
+                s_tvalid->write(1);
+                s_tdata->write(s_tdata->val() + 1);
+            }
+        });
+        r.sched.run(&r.ctx, &r.top);
+        return r.ctx.gotFinish();
+    });
+    report("axibox_seeds", std::to_string(seeds) + " seeds, " + std::to_string(summary.failed) + " failed",
+           {summary.wall_seconds, summary.timesteps, summary.deltas});
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--quick")) quick = true;
+        else filter = argv[i];
+    }
+    auto want = [&](const char* name) { return !filter || std::strstr(name, filter); };
+    const uint64_t T = quick ? 20'000 : 1'000'000;
+
+    if (want("fanout")) {
+        bench_fanout(16, 16, T);
+        bench_fanout(1000, 100, T / 10);
+        bench_fanout(10000, 2000, T / 100);
+    }
+    if (want("delta_chain")) {
+        bench_delta_chain(4, T);
+        bench_delta_chain(64, T / 10);
+    }
+    if (want("static_chain")) bench_static_chain(T);
+    if (want("outputs")) {
+        uint64_t eager = bench_outputs(1000, false, T / 10);
+        uint64_t on_demand = bench_outputs(1000, true, T / 10);
+        uint64_t parallel = bench_outputs(1000, true, T / 10, 4);
+        if (eager != on_demand || eager != parallel) {
+            std::cerr << "[Veroutines] outputs: on-demand edges differ from eager sampling\n";
+            return 1;
+        }
+    }
+    if (want("timed_clocks")) {
+        bench_timed_clocks(4, T);
+        bench_timed_clocks(64, T / 10);
+    }
+    if (want("native_clocks")) {
+        bench_native_clocks(4, T);
+        bench_native_clocks(64, T / 10);
+    }
+    if (want("axibox")) {
+        bench_axibox(false, quick ? 20 : 500);
+        bench_axibox(true, quick ? 20 : 500);
+        bench_axibox_seeds(quick ? 20 : 500);
+    }
+    return 0;
+}
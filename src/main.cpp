@@ -1,12 +1,22 @@
-#include <format>
+#include <array>
 #include <iostream>
+#include <numeric>
 #include <verilated.h>
+#if VM_TRACE_FST
+#include "verilated_fst_c.h"
+using TraceFile = VerilatedFstC;
+#define TRACE_PATH "logs/dump.fst"
+#else
 #include "verilated_vcd_c.h"
+using TraceFile = VerilatedVcdC;
+#define TRACE_PATH "logs/dump.vcd"
+#endif
 #include "Vaxibox.h"
 #include "veroutines.h"
+#include "veroutines_axis.h"
+#include "veroutines_log.h"
 
 using std::cout;
-using std::format;
 using namespace Veroutines;
 
 int main(int argc, char** argv, char**) {
@@ -14,16 +24,14 @@ int main(int argc, char** argv, char**) {
     Verilated::mkdir("logs");
     Verilated::debug(0);
     const std::unique_ptr<VerilatedContext> contextp{new VerilatedContext};
-    const auto tfp = std::make_unique<VerilatedVcdC>();
+    const auto tfp = std::make_unique<TraceFile>();
     const std::unique_ptr<Vaxibox> top{new Vaxibox{contextp.get(), ""}};
 
     contextp->randReset(2);
     contextp->traceEverOn(true);
     contextp->commandArgs(argc, argv);
 
-    top->trace(tfp.get(), 99);
-    tfp->open("logs/dump.vcd");
-    if (!tfp->isOpen()) {
+    if (!open_trace(top.get(), tfp.get(), TRACE_PATH)) {
         cout << "trace not open\n";
         return EXIT_FAILURE;
     }
@@ -48,14 +56,10 @@ int main(int argc, char** argv, char**) {
     auto event_out = sched.output(&top->event_out);
 
     // ========================================================================
-    // Clock Generator (using timed events)
+    // Clock Generator (kernel-native, first rising edge at 0)
     // ========================================================================
 
-    std::function<void()> run_clk = [&]() {
-        clk->write(!clk->val());
-        sched.schedule_after(5, run_clk);  // 10ns period
-    };
-    run_clk();
+    sched.clock(clk, 10);  // 10ns period
 
     // ========================================================================
     // Reset Sequence
@@ -65,50 +69,36 @@ int main(int argc, char** argv, char**) {
     sched.schedule_after(20, [&]() { rst->write(0); });
 
     // ========================================================================
-    // AXI Stream Driver (sensitive to clock + reset)
+    // AXI Stream Source (whole packets, backpressure handled internally)
     // ========================================================================
 
-    uint8_t data_to_send = 0;
-
-    sched.process({clk, rst}, [&](Scheduler& s) {
-        if (clk->posedge() && !rst->val()) {
-            // Check flow control (s_tready is OUTPUT from DUT)
-            if (s_tready->val()) {
-                if (data_to_send < 16) {
-                    s_tvalid->write(1);
-                    s_tdata->write(data_to_send);
-                    cout << format("@{:4d} DRV: Sent 0x{:02X}\n", s.time(), data_to_send);
-                    data_to_send++;
-                } else {
-                    s_tvalid->write(0);
-                    s_tdata->write(0);
-                }
-            }
-        }
-    });
+    std::array<CData, 16> payload;
+    std::iota(payload.begin(), payload.end(), CData{0});
+
+    AxiStreamSource<CData> source(sched, clk, {s_tvalid, s_tdata, s_tready, nullptr, rst});
+    source.send(payload);
 
     // ========================================================================
-    // Monitor (sensitive to clock)
+    // AXI Stream Sink (packets of 4 beats, delivered in batches)
     // ========================================================================
 
-    // Set m_tready = 1 permanently for this test
-    m_tready->write(1);
+    using Packet = AxiStreamSink<CData>::Packet;
 
-    sched.process({clk}, [&](Scheduler& s) {
-        if (clk->posedge() && m_tvalid->val() && m_tready->val()) {
-            uint8_t actual = m_tdata->val();
-            cout << format("@{:4d} MON: Got  0x{:02X} (Reversed)\n", s.time(), actual);
-        }
-    });
+    AxiStreamSink<CData> sink(sched, clk, {m_tvalid, m_tdata, m_tready},
+        [&](std::span<const Packet> packets) {
+            for (const auto& pkt : packets) {
+                const CData* d = pkt.data.data();
+                VR_LOG(Info, pkt.time, "MON: Got 0x{:02X} 0x{:02X} 0x{:02X} 0x{:02X}", d[0], d[1], d[2], d[3]);
+            }
+        },
+        {.packet_beats = 4, .batch = 2});
 
     // ========================================================================
     // Event Listener (sensitive to async event output)
     // ========================================================================
 
-    sched.process({event_out}, [&](Scheduler& s) {
-        if (event_out->posedge()) {
-            cout << format("\n!!! @{:4d} EVENT DETECTED: Counter reached 3 !!!\n\n", s.time());
-        }
+    sched.process({posedge(event_out)}, [&](Scheduler& s) {
+        VR_INFO(s, "!!! EVENT DETECTED: Counter reached 3 !!!");
     });
 
     // ========================================================================
@@ -118,15 +108,18 @@ int main(int argc, char** argv, char**) {
     cout << "Starting Simulation...\n";
     sched.run(contextp.get(), top.get(), tfp.get(), 500);
 
+    sink.flush();
+    default_logger().flush();
     cout << "Simulation Finished.\n";
 
-    if (data_to_send == 16) cout << "SUCCESS: All data sent.\n";
+    if (source.beats_sent() == payload.size()) cout << "SUCCESS: All data sent.\n";
     else cout << "FAILURE: Timed out before sending all data.\n";
 
     // Cleanup
     top->final();
     tfp->close();
     contextp->statsPrintSummary();
+    sched.print_profile();
 
     return 0;
 }
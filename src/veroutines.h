@@ -1,42 +1,343 @@
 #pragma once
 
 #include <vector>
-#include <queue>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <functional>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <coroutine>
+#include <utility>
 #include <iostream>
+#include <span>
+#include <string>
+#include <thread>
 #include <verilated.h>
+#include <verilated_save.h>
+
+// Build with -DVEROUTINES_PROFILE=1 for per-phase counters in Scheduler::run.
+// Compiled out by default; the instrumentation then expands to nothing.
+#ifndef VEROUTINES_PROFILE
+#define VEROUTINES_PROFILE 0
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if VEROUTINES_PROFILE
+#include <chrono>
+#include <iomanip>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#define VR_PROF(...) __VA_ARGS__
+#else
+#define VR_PROF(...)
+#endif
 
 namespace Veroutines {
 
 class Scheduler;
+template<typename, typename, typename> class StaticScheduler;
+
+// -----------------------------------------------------------------------------
+// Action - Move-only void() callable with inline storage
+//
+// Small callables (the usual [&] lambda) live in the object itself, so
+// scheduling one never touches the heap. Larger ones fall back to new.
+// -----------------------------------------------------------------------------
+
+class Action {
+    static constexpr size_t Capacity = 48;
+
+    alignas(std::max_align_t) unsigned char buf_[Capacity];
+    void (*invoke_)(void*) = nullptr;
+    void (*manage_)(void* dst, void* src) = nullptr;  // Move src->dst, or destroy src if !dst
+
+    template<typename F>
+    static constexpr bool fits_inline =
+        sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F>;
+
+public:
+    Action() = default;
+
+    template<typename F, typename D = std::decay_t<F>>
+        requires (!std::is_same_v<D, Action> && std::is_invocable_v<D&>)
+    Action(F&& f) {
+        if constexpr (fits_inline<D>) {
+            new (buf_) D(std::forward<F>(f));
+            invoke_ = [](void* p) { (*static_cast<D*>(p))(); };
+            manage_ = [](void* dst, void* src) {
+                auto* s = static_cast<D*>(src);
+                if (dst) new (dst) D(std::move(*s));
+                s->~D();
+            };
+        } else {
+            *reinterpret_cast<D**>(buf_) = new D(std::forward<F>(f));
+            invoke_ = [](void* p) { (**static_cast<D**>(p))(); };
+            manage_ = [](void* dst, void* src) {
+                auto** s = static_cast<D**>(src);
+                if (dst) *static_cast<D**>(dst) = *s;
+                else delete *s;
+            };
+        }
+    }
+
+    Action(Action&& o) noexcept { take(o); }
+
+    Action& operator=(Action&& o) noexcept {
+        if (this != &o) { reset(); take(o); }
+        return *this;
+    }
+
+    ~Action() { reset(); }
+
+    void operator()() { invoke_(buf_); }
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+    void reset() {
+        if (manage_) manage_(nullptr, buf_);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+private:
+    void take(Action& o) {
+        if (o.manage_) o.manage_(buf_, o.buf_);
+        invoke_ = o.invoke_;
+        manage_ = o.manage_;
+        o.invoke_ = nullptr;
+        o.manage_ = nullptr;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// WriteLog - Port/signal writes deferred during a parallel REACT phase
+//
+// While a worker runs process callbacks, `active` points at its log and
+// write() records the write there instead of staging it; the kernel then
+// replays all logs in PID order, exactly as a serial REACT would have.
+// -----------------------------------------------------------------------------
+
+class Observable;
+
+struct WriteLog {
+    struct Entry {
+        Observable* obs;
+        size_t pid;
+        Action apply;
+    };
+
+    std::vector<Entry> entries;
+    size_t pid = 0;                              // Process running on this thread
+
+    static inline thread_local WriteLog* active = nullptr;
+
+    template<typename F>
+    void record(Observable* o, F&& apply) { entries.push_back({o, pid, Action(std::forward<F>(apply))}); }
+};
 
 // -----------------------------------------------------------------------------
 // Observable - Base for dependency tracking and type erasure
+//
+// Dependents are kept per edge kind so the kernel only wakes processes
+// whose requested edge actually happened.
 // -----------------------------------------------------------------------------
 
+enum class Edge : uint8_t { Any, Pos, Neg };
+
+struct PredicateWait;
+
+// Opt-in change record of one observable (see Scheduler::history)
+class HistoryBase {
+public:
+    virtual ~HistoryBase() = default;
+    virtual void record(uint64_t time) = 0;
+};
+
+// One-shot coroutine waiter, resumed after `remaining` matching edges,
+// or, for predicate waits, once the predicate holds after a change
+struct Waiter {
+    std::coroutine_handle<> handle;
+    Edge edge;
+    uint32_t remaining;
+    PredicateWait* pred = nullptr;
+};
+
 class Observable {
     friend class Scheduler;
+    template<typename, typename, typename> friend class StaticScheduler;
+    friend struct EdgeAwaiter;
+    friend struct PredicateWait;
 protected:
-    std::vector<size_t> dependents_;
+    std::vector<uint32_t> dependents_;     // Any change
+    std::vector<uint32_t> pos_dependents_; // Rising edge only
+    std::vector<uint32_t> neg_dependents_; // Falling edge only
+    std::vector<Waiter> waiters_;          // Suspended coroutines
+    std::vector<Observable*>* dirty_list_ = nullptr;  // Scheduler commit queue
+    HistoryBase* history_ = nullptr;       // Appended to at REACT when it changed
+    uint32_t deps_[4] = {};                // Frozen slice of Scheduler's CSR: Any [0,1), Pos [1,2), Neg [2,3)
+    size_t writer_ = SIZE_MAX;             // Logged writer PID while merging a parallel REACT
+    size_t last_writer_ = SIZE_MAX;        // PID of the last process that wrote it
+    bool dirty_ = false;
+
+    // PID of the process callback running on this thread, SIZE_MAX outside one
+    static inline thread_local size_t running_ = SIZE_MAX;
+
+    // First write in a delta enqueues for commit; later writes just restage
+    void mark_dirty() {
+        if (dirty_) return;
+        dirty_ = true;
+        if (dirty_list_) dirty_list_->push_back(this);
+    }
 
 public:
     virtual ~Observable() = default;
-    virtual void commit() {}
-    virtual void sample() {}
-    virtual bool dirty() const { return false; }
+    virtual bool commit() { return false; }  // Apply staged write; true if value changed
+    virtual void settle() {}                 // Expire last commit's edge (before = value)
+    bool dirty() const { return dirty_; }
     virtual bool changed() const = 0;
+    virtual bool rose() const { return false; }  // Edge hooks for the kernel
+    virtual bool fell() const { return false; }
+
+    // A coroutine started waiting on it
+    virtual void awaited() {}
+
+    // Checkpoint hooks: value state only, never the DUT itself
+    virtual void save(VerilatedSerialize&) const {}
+    virtual void restore(VerilatedDeserialize&) {}
+
+    void add_dependent(uint32_t pid, Edge edge = Edge::Any) {
+        switch (edge) {
+            case Edge::Any: dependents_.push_back(pid); break;
+            case Edge::Pos: pos_dependents_.push_back(pid); break;
+            case Edge::Neg: neg_dependents_.push_back(pid); break;
+        }
+    }
+    const std::vector<uint32_t>& dependents() const { return dependents_; }
+
+    // Something reacts to it: a process (as of the last freeze), a coroutine
+    // or a history ring
+    bool observed() const { return deps_[0] != deps_[3] || !waiters_.empty() || history_; }
+    size_t last_writer() const { return last_writer_; }
+};
+
+// -----------------------------------------------------------------------------
+// Sensitivity - Observable plus the edge a process waits for
+//
+//   sched.process({posedge(clk), negedge(rst), data}, cb);
+// -----------------------------------------------------------------------------
 
-    void add_dependent(size_t pid) { dependents_.push_back(pid); }
-    const std::vector<size_t>& dependents() const { return dependents_; }
+struct Sensitivity {
+    Observable* obs;
+    Edge edge;
+
+    Sensitivity(Observable* o, Edge e = Edge::Any) : obs(o), edge(e) {}
 };
 
+inline Sensitivity posedge(Observable* o) { return {o, Edge::Pos}; }
+inline Sensitivity negedge(Observable* o) { return {o, Edge::Neg}; }
+inline Sensitivity change(Observable* o) { return {o, Edge::Any}; }
+
+// Wide buses have no edges; only change() applies to them
+template<typename> class InputPort;
+template<typename> class OutputPort;
+template<typename> class Signal;
+template<std::size_t N> Sensitivity posedge(InputPort<VlWide<N>>*) = delete;
+template<std::size_t N> Sensitivity posedge(OutputPort<VlWide<N>>*) = delete;
+template<std::size_t N> Sensitivity posedge(Signal<VlWide<N>>*) = delete;
+template<std::size_t N> Sensitivity negedge(InputPort<VlWide<N>>*) = delete;
+template<std::size_t N> Sensitivity negedge(OutputPort<VlWide<N>>*) = delete;
+template<std::size_t N> Sensitivity negedge(Signal<VlWide<N>>*) = delete;
+
+// -----------------------------------------------------------------------------
+// Wide values - VlWide<N> helpers
+//
+// Buses wider than 64 bits are arrays of 32-bit words. They are compared
+// with SIMD where available, read back by const reference, and accessed
+// in slices so a field can be read or written without copying the bus.
+// -----------------------------------------------------------------------------
+
+template<typename T> inline constexpr bool is_wide_v = false;
+template<std::size_t N> inline constexpr bool is_wide_v<VlWide<N>> = true;
+
+// How port values are returned: by value for scalars, by reference for wide
+template<typename T>
+using ValueRef = std::conditional_t<is_wide_v<T>, const T&, T>;
+
+// Value comparison shared by ports and banks
+template<typename T>
+inline bool differs(const T& a, const T& b) { return a != b; }
+
+template<std::size_t N>
+inline bool differs(const VlWide<N>& a, const VlWide<N>& b) {
+    const EData* x = a.data();
+    const EData* y = b.data();
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= N; i += 8) {
+        __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+        acc = _mm256_or_si256(acc, _mm256_xor_si256(u, v));
+    }
+    if (!_mm256_testz_si256(acc, acc)) return true;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 4 <= N; i += 4)
+        acc = vorrq_u32(acc, veorq_u32(vld1q_u32(x + i), vld1q_u32(y + i)));
+    if (vmaxvq_u32(acc)) return true;
+#endif
+    EData rest = 0;
+    for (; i < N; ++i) rest |= x[i] ^ y[i];
+    return rest != 0;
+}
+
+template<std::size_t N>
+inline bool bit(const VlWide<N>& w, std::size_t i) { return w[i / 32] >> (i % 32) & 1; }
+
+// Bits [lsb, lsb + width) as an integer, width <= 64
+template<std::size_t N>
+inline uint64_t bits(const VlWide<N>& w, std::size_t lsb, std::size_t width) {
+    const std::size_t word = lsb / 32;
+    const std::size_t off = lsb % 32;
+    auto at = [&](std::size_t k) -> uint64_t { return word + k < N ? w[word + k] : 0; };
+    uint64_t v = (at(0) | at(1) << 32) >> off;
+    if (off + width > 64) v |= at(2) << (64 - off);
+    return width >= 64 ? v : v & ((uint64_t(1) << width) - 1);
+}
+
+template<std::size_t N>
+inline void set_bits(VlWide<N>& w, std::size_t lsb, std::size_t width, uint64_t v) {
+    while (width) {
+        const std::size_t word = lsb / 32;
+        const std::size_t off = lsb % 32;
+        const std::size_t n = std::min<std::size_t>(width, 32 - off);
+        const EData mask = EData(((uint64_t(1) << n) - 1) << off);
+        w[word] = (w[word] & ~mask) | (EData(v << off) & mask);
+        v >>= n;
+        lsb += n;
+        width -= n;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // InputPort<T> - Boundary: Testbench -> DUT
 //
 // Buffers writes until commit, then applies to DUT.
 // Tracks edges so processes can react to C++-driven signals (e.g. clock).
+// Writing the value the DUT already sees, with nothing staged, is a no-op.
 // -----------------------------------------------------------------------------
 
 template<typename T>
@@ -45,284 +346,2466 @@ class InputPort : public Observable {
     T staged_;     // Buffered write, applied on commit
     T value_;      // Committed value (what DUT sees)
     T before_;     // Value before last commit (for edges)
-    bool dirty_ = false;
 
 public:
     explicit InputPort(T* ptr)
         : ptr_(ptr), staged_(*ptr), value_(*ptr), before_(*ptr) {}
 
-    void write(T v) { staged_ = v; dirty_ = true; }
+    void write(T v) {
+        if (WriteLog::active) [[unlikely]]
+            return WriteLog::active->record(this, [this, v] { write(v); });
+        if (!dirty_ && !differs(v, value_)) return;
+        staged_ = v;
+        last_writer_ = running_;
+        mark_dirty();
+    }
 
-    void commit() override {
+    bool commit() override {
         before_ = value_;
-        if (dirty_) {
-            *ptr_ = staged_;
-            value_ = staged_;
-            dirty_ = false;
-        }
+        *ptr_ = staged_;
+        value_ = staged_;
+        dirty_ = false;
+        return value_ != before_;
     }
 
-    bool dirty() const override { return dirty_; }
+    void settle() override { before_ = value_; }
+
     bool changed() const override { return value_ != before_; }
     bool posedge() const { return !before_ && value_; }
     bool negedge() const { return before_ && !value_; }
+    bool rose() const override { return posedge(); }
+    bool fell() const override { return negedge(); }
+
+    void save(VerilatedSerialize& os) const override {
+        os.write(&staged_, sizeof(T)).write(&value_, sizeof(T)).write(&before_, sizeof(T));
+    }
+
+    void restore(VerilatedDeserialize& is) override {
+        is.read(&staged_, sizeof(T)).read(&value_, sizeof(T)).read(&before_, sizeof(T));
+        *ptr_ = value_;
+    }
 
     T val() const { return value_; }
     operator T() const { return value_; }
 };
 
 // -----------------------------------------------------------------------------
-// OutputPort<T> - Boundary: DUT -> Testbench
+// InputPort<VlWide<N>> - Wide bus input
 //
-// Samples DUT output each delta. Read-only from testbench.
-// Tracks edges for process triggering.
+// staged/value/before live in three rotating buffers: commit moves indices
+// instead of copying the bus, and edge expiry is a flag. A full write costs
+// one copy into staging plus the copy into the DUT. No posedge/negedge.
 // -----------------------------------------------------------------------------
 
-template<typename T>
-class OutputPort : public Observable {
-    T* ptr_;       // -> DUT output
-    T value_;      // Current sampled value
-    T before_;     // Value before last sample (for edges)
+template<std::size_t N>
+class InputPort<VlWide<N>> : public Observable {
+    using T = VlWide<N>;
+
+    T* ptr_;                   // -> DUT input
+    std::array<T, 3> buf_;
+    uint8_t staged_ = 0;
+    uint8_t value_ = 1;
+    uint8_t before_ = 2;
+    bool settled_ = true;      // Edge expired: before reads as value
+    bool changed_ = false;     // Last commit changed the value
 
 public:
-    explicit OutputPort(T* ptr)
-        : ptr_(ptr), value_(*ptr), before_(*ptr) {}
+    explicit InputPort(T* ptr) : ptr_(ptr) { buf_.fill(*ptr); }
+
+    void write(const T& v) {
+        if (WriteLog::active) [[unlikely]]
+            return WriteLog::active->record(this, [this, v] { write(v); });
+        if (!dirty_ && !differs(v, val())) return;
+        buf_[staged_] = v;
+        last_writer_ = running_;
+        mark_dirty();
+    }
+
+    // Write bits [lsb, lsb + width) only (width <= 64); the rest of the
+    // bus keeps the value staged so far in this delta
+    void write_bits(std::size_t lsb, std::size_t width, uint64_t v) {
+        if (WriteLog::active) [[unlikely]]
+            return WriteLog::active->record(this, [this, lsb, width, v] { write_bits(lsb, width, v); });
+        if (!dirty_) {
+            uint64_t mask = width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+            if (Veroutines::bits(val(), lsb, width) == (v & mask)) return;
+            buf_[staged_] = val();
+        }
+        set_bits(buf_[staged_], lsb, width, v);
+        last_writer_ = running_;
+        mark_dirty();
+    }
 
-    void sample() override {
+    bool commit() override {
+        uint8_t free = before_;
         before_ = value_;
-        value_ = *ptr_;
+        value_ = staged_;
+        staged_ = free;
+        settled_ = false;
+        *ptr_ = buf_[value_];
+        dirty_ = false;
+        changed_ = differs(buf_[value_], buf_[before_]);
+        return changed_;
     }
 
-    bool changed() const override { return value_ != before_; }
-    bool posedge() const { return !before_ && value_; }
-    bool negedge() const { return before_ && !value_; }
+    void settle() override {
+        settled_ = true;
+        changed_ = false;
+    }
 
-    T val() const { return value_; }
-    operator T() const { return value_; }
+    bool changed() const override { return changed_; }
+
+    void save(VerilatedSerialize& os) const override {
+        os.write(&buf_[staged_], sizeof(T)).write(&val(), sizeof(T)).write(&before(), sizeof(T));
+    }
+
+    void restore(VerilatedDeserialize& is) override {
+        staged_ = 0;
+        value_ = 1;
+        before_ = 2;
+        is.read(&buf_[0], sizeof(T)).read(&buf_[1], sizeof(T)).read(&buf_[2], sizeof(T));
+        settled_ = false;
+        changed_ = differs(buf_[1], buf_[2]);
+        *ptr_ = buf_[value_];
+    }
+
+    const T& val() const { return buf_[value_]; }
+    const T& before() const { return buf_[settled_ ? value_ : before_]; }
+    operator const T&() const { return val(); }
+
+    bool bit(std::size_t i) const { return Veroutines::bit(val(), i); }
+    uint64_t bits(std::size_t lsb, std::size_t width) const { return Veroutines::bits(val(), lsb, width); }
+    std::span<const EData, N> words() const { return std::span<const EData, N>(val().data(), N); }
 };
 
 // -----------------------------------------------------------------------------
-// Signal<T> - Internal testbench state with NBA semantics
+// OutputBank<T> - Flat sample storage for all OutputPort<T> of one width
 //
-// Writes buffered until commit. Enables derived clocks, state machines.
+// Struct-of-arrays (dut pointer, current, previous) per CData/SData/IData/
+// QData/VlWide type, so SAMPLE is a few tight loops over contiguous arrays
+// instead of a virtual call per port. Change detection is folded into a
+// bitmask in the same pass, and current/previous are two buffers that
+// swap roles, so a sample copies each value once.
 // -----------------------------------------------------------------------------
 
-template<typename T>
-class Signal : public Observable {
-    T staged_;     // Buffered write, applied on commit
-    T value_;      // Committed value
-    T before_;     // Value before last commit (for edges)
-    bool dirty_ = false;
+class OutputBankBase {
+protected:
+    bool pending_ = false;  // Last sample changed something; its edges are still visible
+    std::atomic<bool> repartition_{false};  // A port was pinned during a parallel REACT
 
 public:
-    explicit Signal(T initial = T{})
-        : staged_(initial), value_(initial), before_(initial) {}
+    virtual ~OutputBankBase() = default;
+    virtual void sample(std::vector<Observable*>& changed) = 0;
+    virtual void partition(const uint64_t* epoch) = 0;  // On-demand sampling; null = all eager
+    virtual void refresh() = 0;   // Read every on-demand slot for the current epoch
+    virtual void settle() = 0;    // Apply a partition deferred by a parallel REACT
+    bool pending() const { return pending_; }
+};
+
+template<typename T>
+class OutputBank : public OutputBankBase {
+    template<typename> friend class OutputPort;
+
+    std::vector<const T*> ptr_;       // -> DUT outputs
+    std::array<std::vector<T>, 2> samples_;  // Current and previous, swapped per sample
+    uint8_t cur_ = 0;
+    std::vector<uint64_t> changed_;   // Bit per port, set if last sample changed it
+    std::vector<OutputPort<T>*> ports_;  // Owning OutputPort per slot
+
+    // On-demand slots [eager_, size) are not sampled per delta; each read
+    // in a new epoch moves value to before and reloads value from the DUT
+    struct Lazy {
+        T value;
+        T before;
+        uint64_t seen;                // Epoch of the last read, MAX if never read
+    };
+    std::vector<Lazy> lazy_;
+    size_t eager_ = SIZE_MAX;
+    const uint64_t* epoch_ = nullptr;
+
+    size_t add(const T* ptr, OutputPort<T>* port) {
+        size_t idx = ptr_.size();
+        ptr_.push_back(ptr);
+        samples_[0].push_back(*ptr);
+        samples_[1].push_back(*ptr);
+        ports_.push_back(port);
+        if (idx % 64 == 0) changed_.push_back(0);
+        if (eager_ != SIZE_MAX) lazy_.push_back({*ptr, *ptr, UINT64_MAX});
+        return idx;
+    }
 
-    void write(T v) { staged_ = v; dirty_ = true; }
+    bool is_lazy(size_t idx) const { return idx >= eager_; }
 
-    void commit() override {
-        before_ = value_;
-        if (dirty_) {
-            value_ = staged_;
-            dirty_ = false;
+    Lazy& lazy(size_t idx) {
+        Lazy& l = lazy_[idx - eager_];
+        if (l.seen != *epoch_) {
+            l.before = l.value;
+            l.value = *ptr_[idx];
+            l.seen = *epoch_;
         }
+        return l;
     }
 
-    bool dirty() const override { return dirty_; }
-    bool changed() const override { return value_ != before_; }
-    bool posedge() const { return !before_ && value_; }
-    bool negedge() const { return before_ && !value_; }
+    T& value(size_t idx) { return is_lazy(idx) ? lazy(idx).value : samples_[cur_][idx]; }
+    T& before(size_t idx) { return is_lazy(idx) ? lazy(idx).before : samples_[cur_ ^ 1][idx]; }
 
-    T val() const { return value_; }
-    operator T() const { return value_; }
+    bool changed(size_t idx) {
+        if (is_lazy(idx)) {
+            Lazy& l = lazy(idx);
+            return differs(l.value, l.before);
+        }
+        return changed_[idx / 64] >> (idx % 64) & 1;
+    }
 
-    Signal& operator=(T v) { write(v); return *this; }
-};
+public:
+    void sample(std::vector<Observable*>& changed) override {
+        sample_each([&](Observable* p) { changed.push_back(p); });
+    }
 
-// -----------------------------------------------------------------------------
-// Process - Callback triggered by signal changes
-// -----------------------------------------------------------------------------
+    // Sample every eager slot, calling on_change(port) for each that changed
+    template<typename F>
+    void sample_each(F&& on_change) {
+        const size_t n = std::min(ptr_.size(), eager_);
+
+        // New values overwrite the sample before last, so the previous
+        // one becomes `before` without a copy
+        cur_ ^= 1;
+        T* __restrict value = samples_[cur_].data();
+        const T* __restrict before = samples_[cur_ ^ 1].data();
+        for (size_t i = 0; i < n; ++i) value[i] = *ptr_[i];
+
+        uint64_t any = 0;
+        for (size_t base = 0; base < n; base += 64) {
+            const size_t len = std::min<size_t>(64, n - base);
+            uint64_t mask = 0;
+            for (size_t i = 0; i < len; ++i)
+                mask |= uint64_t(differs(value[base + i], before[base + i])) << i;
+            changed_[base / 64] = mask;
+            any |= mask;
+            for (; mask; mask &= mask - 1)
+                on_change(ports_[base + std::countr_zero(mask)]);
+        }
+        pending_ = any != 0;
+    }
 
-struct Process {
-    using Callback = std::function<void(Scheduler&)>;
-    Callback callback;
-    bool always_active;  // Run every delta regardless of triggers
+    // Move slots of unwatched ports (no process or coroutine waiting, edges
+    // never read) to
+    // the on-demand tail, or everything back to eager when epoch is null.
+    // Ports keep their handles; only their slot index changes.
+    void partition(const uint64_t* epoch) override {
+        const size_t n = ptr_.size();
+        std::vector<size_t> order;
+        order.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            if (!epoch || ports_[i]->eager()) order.push_back(i);
+        const size_t eager = order.size();
+        for (size_t i = 0; i < n; ++i)
+            if (epoch && !ports_[i]->eager()) order.push_back(i);
+
+        std::vector<const T*> ptr(n);
+        std::array<std::vector<T>, 2> samples{std::vector<T>(n), std::vector<T>(n)};
+        std::vector<OutputPort<T>*> ports(n);
+        std::vector<uint64_t> changed((n + 63) / 64, 0);
+        std::vector<Lazy> lazy;
+        for (size_t k = 0; k < n; ++k) {
+            size_t i = order[k];
+            bool was_changed = this->changed(i);
+            ptr[k] = ptr_[i];
+            samples[0][k] = value(i);
+            samples[1][k] = before(i);
+            ports[k] = ports_[i];
+            ports[k]->idx_ = k;
+            if (k < eager) changed[k / 64] |= uint64_t(was_changed) << (k % 64);
+            else lazy.push_back({samples[0][k], samples[1][k], UINT64_MAX});
+        }
+        ptr_ = std::move(ptr);
+        samples_ = std::move(samples);
+        cur_ = 0;
+        ports_ = std::move(ports);
+        changed_ = std::move(changed);
+        lazy_ = std::move(lazy);
+        eager_ = epoch ? eager : SIZE_MAX;
+        epoch_ = epoch;
+    }
+
+    // Before a parallel REACT: with every on-demand slot read for this
+    // epoch, reads from worker threads leave the bank untouched
+    void refresh() override {
+        if (eager_ == SIZE_MAX) return;
+        for (size_t i = eager_; i < ptr_.size(); ++i) lazy(i);
+    }
+
+    void settle() override {
+        if (repartition_.exchange(false, std::memory_order_relaxed)) partition(epoch_);
+    }
+
+    // A coroutine started waiting on a lazy slot: sample it eagerly from now
+    // on. On a REACT worker the slots must not move, so wait for settle().
+    void make_eager(size_t idx) {
+        if (!is_lazy(idx)) return;
+        if (WriteLog::active) repartition_.store(true, std::memory_order_relaxed);
+        else partition(epoch_);
+    }
+
+    // Rebuild the change bit of a slot whose value/before were restored
+    void restored(size_t idx) {
+        if (is_lazy(idx)) {
+            lazy_[idx - eager_].seen = *epoch_;
+            return;
+        }
+        uint64_t bit = uint64_t(1) << (idx % 64);
+        if (differs(value(idx), before(idx))) {
+            changed_[idx / 64] |= bit;
+            pending_ = true;
+        } else {
+            changed_[idx / 64] &= ~bit;
+        }
+    }
 };
 
 // -----------------------------------------------------------------------------
-// Scheduler - 5-phase execution kernel
+// OutputPort<T> - Boundary: DUT -> Testbench
 //
-// 1. COMMIT   - Apply staged writes, capture edges
-// 2. EVAL     - model.eval()
-// 3. SAMPLE   - Capture DUT outputs
-// 4. REACT    - Trigger and run processes
-// 5. CONVERGE - Loop if dirty, else advance time
+// Sampled by its OutputBank each delta. Read-only from testbench.
+// Tracks edges for process triggering. With on-demand sampling, a port no
+// process or coroutine waits on is read from the DUT when val() is read;
+// reading its edges switches it back to per-delta sampling.
 // -----------------------------------------------------------------------------
 
-class Scheduler {
-public:
-    using Action = std::function<void()>;
-
-private:
-    struct TimedEvent {
-        uint64_t time;
-        Action action;
-        bool operator>(const TimedEvent& o) const { return time > o.time; }
-    };
-    std::priority_queue<TimedEvent, std::vector<TimedEvent>, std::greater<>> time_events_;
+template<typename T>
+class OutputPort : public Observable {
+    template<typename> friend class OutputBank;
 
-    std::vector<std::unique_ptr<Observable>> owned_;
-    std::vector<Observable*> inputs_;
-    std::vector<Observable*> outputs_;
-    std::vector<Observable*> signals_;
+    OutputBank<T>* bank_;
+    size_t idx_;
+    std::atomic<bool> pinned_{false};   // Edges were read: never on-demand
 
-    std::vector<Process> processes_;
-    std::vector<bool> triggered_;
+    bool eager() const { return pinned_.load(std::memory_order_relaxed) || observed(); }
 
-    uint64_t current_time_ = 0;
+    // On-demand slots have no previous-delta sample to compare against
+    void pin() const {
+        if (bank_->is_lazy(idx_)) [[unlikely]] const_cast<OutputPort*>(this)->sample_eagerly();
+    }
 
 public:
+    OutputPort(OutputBank<T>* bank, const T* ptr)
+        : bank_(bank), idx_(bank->add(ptr, this)) {}
 
-    // --- Registration ---
+    // Keep sampling this port every delta under on-demand sampling
+    void sample_eagerly() {
+        pinned_.store(true, std::memory_order_relaxed);
+        bank_->make_eager(idx_);
+    }
 
-    template<typename T>
-    InputPort<T>* input(T* dut_ptr) {
-        auto p = std::make_unique<InputPort<T>>(dut_ptr);
-        auto* h = p.get();
-        inputs_.push_back(h);
-        owned_.push_back(std::move(p));
-        return h;
+    bool changed() const override {
+        pin();
+        return bank_->changed(idx_);
     }
+    bool posedge() const requires (!is_wide_v<T>) { return !before() && val(); }
+    bool negedge() const requires (!is_wide_v<T>) { return before() && !val(); }
 
-    template<typename T>
-    OutputPort<T>* output(T* dut_ptr) {
-        auto p = std::make_unique<OutputPort<T>>(dut_ptr);
-        auto* h = p.get();
-        outputs_.push_back(h);
-        owned_.push_back(std::move(p));
-        return h;
+    bool rose() const override {
+        if constexpr (is_wide_v<T>) return false;
+        else return posedge();
     }
 
-    template<typename T>
-    Signal<T>* signal(T initial = T{}) {
-        auto p = std::make_unique<Signal<T>>(initial);
-        auto* h = p.get();
-        signals_.push_back(h);
-        owned_.push_back(std::move(p));
-        return h;
+    bool fell() const override {
+        if constexpr (is_wide_v<T>) return false;
+        else return negedge();
     }
 
-    void process(std::initializer_list<Observable*> sens, Process::Callback cb) {
-        size_t pid = processes_.size();
-        processes_.push_back({std::move(cb), false});
-        triggered_.push_back(false);
-        for (auto* obs : sens)
-            obs->add_dependent(pid);
+    void awaited() override {
+        if (bank_->is_lazy(idx_)) bank_->make_eager(idx_);
     }
 
-    void always(Process::Callback cb) {
-        processes_.push_back({std::move(cb), true});
-        triggered_.push_back(false);
+    void save(VerilatedSerialize& os) const override {
+        os.write(&bank_->value(idx_), sizeof(T)).write(&bank_->before(idx_), sizeof(T));
     }
 
-    // --- Scheduling ---
+    void restore(VerilatedDeserialize& is) override {
+        is.read(&bank_->value(idx_), sizeof(T)).read(&bank_->before(idx_), sizeof(T));
+        bank_->restored(idx_);
+    }
 
-    uint64_t time() const { return current_time_; }
+    ValueRef<T> val() const { return bank_->value(idx_); }
+    ValueRef<T> before() const {
+        pin();
+        return bank_->before(idx_);
+    }
+    operator ValueRef<T>() const { return val(); }
 
-    void schedule_after(uint64_t delay, Action action) {
-        time_events_.push({current_time_ + delay, std::move(action)});
+    // Slices of a wide output, read in place
+    bool bit(size_t i) const requires is_wide_v<T> { return Veroutines::bit(val(), i); }
+    uint64_t bits(size_t lsb, size_t width) const requires is_wide_v<T> {
+        return Veroutines::bits(val(), lsb, width);
+    }
+    auto words() const requires is_wide_v<T> {
+        return std::span<const EData, T::Words>(val().data(), T::Words);
     }
+};
+
+// -----------------------------------------------------------------------------
+// Signal<T> - Internal testbench state with NBA semantics
+//
+// Writes buffered until commit. Enables derived clocks, state machines.
+// As with InputPort, rewriting the current value does not mark it dirty.
+// -----------------------------------------------------------------------------
+
+template<typename T>
+class Signal : public Observable {
+    T staged_;     // Buffered write, applied on commit
+    T value_;      // Committed value
+    T before_;     // Value before last commit (for edges)
+
+public:
+    explicit Signal(T initial = T{})
+        : staged_(initial), value_(initial), before_(initial) {}
 
-    void schedule_at(uint64_t t, Action action) {
-        time_events_.push({t, std::move(action)});
+    void write(ValueRef<T> v) {
+        if (WriteLog::active) [[unlikely]]
+            return WriteLog::active->record(this, [this, v] { write(v); });
+        if (!dirty_ && !differs(v, value_)) return;
+        staged_ = v;
+        last_writer_ = running_;
+        mark_dirty();
     }
 
-    // --- Main Loop ---
+    bool commit() override {
+        before_ = value_;
+        value_ = staged_;
+        dirty_ = false;
+        return differs(value_, before_);
+    }
 
-    template<typename TopModel, typename Trace = int>
-    void run(VerilatedContext* ctx, TopModel* top, Trace* tfp = nullptr,
-             uint64_t timeout = UINT64_MAX) {
+    void settle() override { before_ = value_; }
 
-        if (tfp) tfp->dump(0);
+    bool changed() const override { return differs(value_, before_); }
+    bool posedge() const requires (!is_wide_v<T>) { return !before_ && value_; }
+    bool negedge() const requires (!is_wide_v<T>) { return before_ && !value_; }
 
-        while (!ctx->gotFinish() && ctx->time() < timeout) {
+    bool rose() const override {
+        if constexpr (is_wide_v<T>) return false;
+        else return posedge();
+    }
 
-            // Time advancement
-            uint64_t t_cosim = time_events_.empty() ? UINT64_MAX : time_events_.top().time;
-            uint64_t t_model = top->eventsPending() ? top->nextTimeSlot() : UINT64_MAX;
-            uint64_t t_next = std::min(t_cosim, t_model);
-            if (t_next == UINT64_MAX) break;
+    bool fell() const override {
+        if constexpr (is_wide_v<T>) return false;
+        else return negedge();
+    }
 
-            ctx->time(t_next);
-            current_time_ = t_next;
+    void save(VerilatedSerialize& os) const override {
+        os.write(&staged_, sizeof(T)).write(&value_, sizeof(T)).write(&before_, sizeof(T));
+    }
 
-            // Fire timed events (may stage writes)
-            while (!time_events_.empty() && time_events_.top().time == current_time_) {
-                auto ev = std::move(const_cast<TimedEvent&>(time_events_.top()));
-                time_events_.pop();
-                ev.action();
-            }
+    void restore(VerilatedDeserialize& is) override {
+        is.read(&staged_, sizeof(T)).read(&value_, sizeof(T)).read(&before_, sizeof(T));
+    }
 
-            // Delta convergence loop
-            int delta = 0;
-            while (true) {
+    ValueRef<T> val() const { return value_; }
+    operator ValueRef<T>() const { return value_; }
 
-                // PHASE 1: COMMIT
-                for (auto* p : inputs_)  p->commit();
-                for (auto* p : signals_) p->commit();
+    Signal& operator=(T v) { write(v); return *this; }
+};
 
-                // PHASE 2: EVAL
-                bool need_eval = has_dirty_input() || has_dirty_signal() ||
-                                 (top->eventsPending() && top->nextTimeSlot() <= t_next);
-                if (need_eval || delta == 0)
-                    top->eval();
+// -----------------------------------------------------------------------------
+// History<P> - Last changes of one port or signal
+//
+// A fixed ring of (time, value) entries, appended by the kernel at REACT
+// in every delta the observable changed, plus the value at the time the
+// ring was attached. Reads are by time, so a clocked checker can ask for
+// the value sampled at an edge (the one held just before it) without
+// keeping a copy per cycle.
+// -----------------------------------------------------------------------------
 
-                // PHASE 3: SAMPLE
-                for (auto* p : outputs_) p->sample();
+template<typename P>
+class History : public HistoryBase {
+public:
+    using T = std::decay_t<decltype(std::declval<const P&>().val())>;
 
-                // PHASE 4: REACT
-                std::fill(triggered_.begin(), triggered_.end(), false);
+    struct Entry {
+        uint64_t time;
+        T value;
+    };
 
-                for (auto* o : inputs_)
-                    if (o->changed())
-                        for (size_t pid : o->dependents()) triggered_[pid] = true;
+private:
+    const P* obs_;
+    std::vector<Entry> ring_;
+    uint64_t mask_;
+    uint64_t count_ = 0;
 
-                for (auto* o : signals_)
-                    if (o->changed())
-                        for (size_t pid : o->dependents()) triggered_[pid] = true;
+public:
+    History(const P* obs, size_t depth, uint64_t now) {
+        size_t n = 2;
+        while (n < depth) n <<= 1;
+        obs_ = obs;
+        ring_.resize(n);
+        mask_ = n - 1;
+        record(now);
+    }
 
-                for (auto* o : outputs_)
-                    if (o->changed())
-                        for (size_t pid : o->dependents()) triggered_[pid] = true;
+    void record(uint64_t time) override {
+        Entry& e = ring_[count_ & mask_];
+        e.time = time;
+        e.value = obs_->val();
+        ++count_;
+    }
 
-                for (size_t i = 0; i < processes_.size(); ++i)
-                    if (triggered_[i] || processes_[i].always_active)
-                        processes_[i].callback(*this);
+    // Retained entries; [0] is the newest
+    size_t size() const { return size_t(std::min<uint64_t>(count_, ring_.size())); }
+    const Entry& operator[](size_t k) const { return ring_[(count_ - 1 - k) & mask_]; }
+    uint64_t last_change() const { return (*this)[0].time; }
 
-                // PHASE 5: CONVERGENCE
-                if (!has_dirty_input() && !has_dirty_signal())
-                    break;
+    // False once entries older than t have been overwritten
+    bool covers(uint64_t t) const { return count_ <= ring_.size() || (*this)[size() - 1].time < t; }
 
-                if (++delta > 1000) {
-                    std::cerr << "[Veroutines] Combinational loop at t=" << t_next << "\n";
-                    return;
-                }
-            }
+    // Value held just before time t (the oldest retained if t predates it)
+    const T& before(uint64_t t) const {
+        const size_t n = size();
+        for (size_t k = 0; k < n; ++k)
+            if ((*this)[k].time < t) return (*this)[k].value;
+        return (*this)[n - 1].value;
+    }
 
-            if (tfp) tfp->dump(ctx->time());
+    // Same value just before `from`, just before `to`, and at every change
+    // in between
+    bool stable(uint64_t from, uint64_t to) const {
+        if (!covers(from)) return false;
+        const T& v = before(to);
+        for (size_t k = 0, n = size(); k < n; ++k) {
+            const Entry& e = (*this)[k];
+            if (e.time >= to) continue;
+            if (differs(e.value, v)) return false;
+            if (e.time < from) break;
         }
+        return true;
     }
+};
+
+// -----------------------------------------------------------------------------
+// TimingWheel - Timed-event queue
+//
+// Events within Slots ticks of the current time sit in a bucket indexed by
+// time; insert and pop are O(1), and an occupancy bitmap finds the next
+// non-empty bucket. Farther events wait in an overflow heap and migrate
+// into the wheel as time advances. Nodes are pooled and reused, and each
+// bucket is a FIFO so same-timestamp events fire in scheduling order.
+//
+// push() returns a TimerId; cancel() unlinks a pending event in O(1) from
+// a bucket or O(log n) from the overflow heap, and ignores stale ids.
+// -----------------------------------------------------------------------------
+
+struct TimerId {
+    uint32_t node = UINT32_MAX;
+    uint32_t gen = 0;
+};
+
+class TimingWheel {
+public:
+    static constexpr uint64_t Slots = 256;
 
 private:
-    bool has_dirty_input() const {
-        for (auto* p : inputs_) if (p->dirty()) return true;
-        return false;
+    static constexpr uint32_t Nil = UINT32_MAX;
+    static constexpr size_t Words = Slots / 64;
+
+    struct Node {
+        uint64_t time;
+        uint64_t seq;       // Insertion order, keeps overflow FIFO per timestamp
+        uint32_t next;      // Bucket list or free list link
+        uint32_t prev;      // Bucket list back link
+        uint32_t heap_pos;  // Index in overflow_, Nil while in a bucket
+        uint32_t gen;       // Bumped on release; invalidates old TimerIds
+        bool pending;
+        Action action;
+    };
+
+    struct Bucket { uint32_t head = Nil, tail = Nil; };
+
+    std::vector<Node> nodes_;       // Pool
+    uint32_t free_ = Nil;
+    std::array<Bucket, Slots> buckets_{};
+    std::array<uint64_t, Words> occupied_{};
+    std::vector<uint32_t> overflow_;  // Min-heap on (time, seq)
+    uint64_t now_ = 0;                // Wheel covers [now_, now_ + Slots)
+    uint64_t seq_ = 0;
+    size_t size_ = 0;
+
+    bool earlier(uint32_t a, uint32_t b) const {
+        const Node& x = nodes_[a];
+        const Node& y = nodes_[b];
+        return x.time != y.time ? x.time < y.time : x.seq < y.seq;
     }
 
-    bool has_dirty_signal() const {
-        for (auto* p : signals_) if (p->dirty()) return true;
-        return false;
+    uint32_t alloc() {
+        if (free_ != Nil) {
+            uint32_t n = free_;
+            free_ = nodes_[n].next;
+            return n;
+        }
+        nodes_.push_back({0, 0, Nil, Nil, Nil, 0, false, {}});
+        return uint32_t(nodes_.size() - 1);
     }
-};
+
+    void release(uint32_t n) {
+        Node& node = nodes_[n];
+        node.pending = false;
+        ++node.gen;
+        node.next = free_;
+        free_ = n;
+        --size_;
+    }
+
+    // --- Buckets ---
+
+    void link(uint32_t n) {
+        size_t slot = nodes_[n].time & (Slots - 1);
+        Bucket& b = buckets_[slot];
+        nodes_[n].next = Nil;
+        nodes_[n].prev = b.tail;
+        nodes_[n].heap_pos = Nil;
+        if (b.tail == Nil) b.head = n;
+        else nodes_[b.tail].next = n;
+        b.tail = n;
+        occupied_[slot / 64] |= uint64_t(1) << (slot % 64);
+    }
+
+    void unlink(uint32_t n) {
+        size_t slot = nodes_[n].time & (Slots - 1);
+        Bucket& b = buckets_[slot];
+        uint32_t next = nodes_[n].next;
+        uint32_t prev = nodes_[n].prev;
+        if (prev == Nil) b.head = next;
+        else nodes_[prev].next = next;
+        if (next == Nil) b.tail = prev;
+        else nodes_[next].prev = prev;
+        if (b.head == Nil)
+            occupied_[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+
+    // --- Overflow heap (tracks positions so entries can be removed) ---
+
+    void heap_set(size_t i, uint32_t n) {
+        overflow_[i] = n;
+        nodes_[n].heap_pos = uint32_t(i);
+    }
+
+    void sift_up(size_t i) {
+        uint32_t n = overflow_[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!earlier(n, overflow_[parent])) break;
+            heap_set(i, overflow_[parent]);
+            i = parent;
+        }
+        heap_set(i, n);
+    }
+
+    void sift_down(size_t i) {
+        uint32_t n = overflow_[i];
+        const size_t size = overflow_.size();
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= size) break;
+            if (child + 1 < size && earlier(overflow_[child + 1], overflow_[child])) ++child;
+            if (!earlier(overflow_[child], n)) break;
+            heap_set(i, overflow_[child]);
+            i = child;
+        }
+        heap_set(i, n);
+    }
+
+    void heap_push(uint32_t n) {
+        overflow_.push_back(n);
+        sift_up(overflow_.size() - 1);
+    }
+
+    void heap_erase(size_t i) {
+        uint32_t last = overflow_.back();
+        overflow_.pop_back();
+        if (i == overflow_.size()) return;
+        heap_set(i, last);
+        sift_up(i);
+        sift_down(nodes_[last].heap_pos);
+    }
+
+public:
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    TimerId push(uint64_t t, Action action) {
+        if (t < now_) t = now_;
+        uint32_t n = alloc();
+        Node& node = nodes_[n];
+        node.time = t;
+        node.seq = seq_++;
+        node.pending = true;
+        node.action = std::move(action);
+        ++size_;
+        if (t - now_ < Slots) link(n);
+        else heap_push(n);
+        return {n, node.gen};
+    }
+
+    // Drop a pending event; false if it already fired or was cancelled
+    bool cancel(TimerId id) {
+        if (id.node >= nodes_.size()) return false;
+        Node& node = nodes_[id.node];
+        if (!node.pending || node.gen != id.gen) return false;
+        if (node.heap_pos == Nil) unlink(id.node);
+        else heap_erase(node.heap_pos);
+        node.action.reset();
+        release(id.node);
+        return true;
+    }
+
+    // Earliest pending time, UINT64_MAX if empty
+    uint64_t next_time() const {
+        const size_t start = now_ & (Slots - 1);
+        const size_t w0 = start / 64;
+        const uint64_t lo = ~uint64_t(0) << (start % 64);
+        for (size_t k = 0; k <= Words; ++k) {
+            size_t w = (w0 + k) % Words;
+            uint64_t bits = occupied_[w];
+            if (k == 0) bits &= lo;
+            else if (k == Words) bits &= ~lo;
+            if (bits) {
+                size_t slot = w * 64 + std::countr_zero(bits);
+                return nodes_[buckets_[slot].head].time;
+            }
+        }
+        return overflow_.empty() ? UINT64_MAX : nodes_[overflow_.front()].time;
+    }
+
+    // Move the window to t (must not pass next_time())
+    void advance(uint64_t t) {
+        if (t <= now_) return;
+        now_ = t;
+        while (!overflow_.empty() && nodes_[overflow_.front()].time - now_ < Slots) {
+            uint32_t n = overflow_.front();
+            heap_erase(0);
+            link(n);
+        }
+    }
+
+    // Drop every pending event and restart the window at `now`
+    void reset(uint64_t now) {
+        for (uint32_t n = 0; n < nodes_.size(); ++n) {
+            if (!nodes_[n].pending) continue;
+            nodes_[n].action.reset();
+            release(n);
+        }
+        buckets_.fill({});
+        occupied_.fill(0);
+        overflow_.clear();
+        now_ = now;
+    }
+
+    // Take the next event due at the current time, in FIFO order
+    bool pop(Action& out) {
+        Bucket& b = buckets_[now_ & (Slots - 1)];
+        uint32_t n = b.head;
+        if (n == Nil || nodes_[n].time != now_) return false;
+
+        unlink(n);
+        out = std::move(nodes_[n].action);
+        release(n);
+        return true;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// PredicateWait - Coroutine waiting for a predicate over a set of observables
+//
+// Registered as a waiter on every dependency; the kernel re-checks the
+// predicate only when one of them changes. See until() / timeout().
+// -----------------------------------------------------------------------------
+
+struct PredicateWait {
+    std::coroutine_handle<> handle;
+    bool (*check)(void*);
+    void* ctx;
+    Observable* const* deps;                  // Lives in the awaiter
+    size_t ndeps;
+    TimerId timer;
+    bool timed = false;
+    bool done = false;
+    bool satisfied = false;
+
+    void arm() {
+        for (size_t i = 0; i < ndeps; ++i)
+            deps[i]->waiters_.push_back({handle, Edge::Any, 1, this});
+        for (size_t i = 0; i < ndeps; ++i)
+            deps[i]->awaited();
+    }
+
+    // Unregister everywhere but `skip` (the list the kernel is compacting)
+    void disarm(Observable* skip) {
+        for (size_t i = 0; i < ndeps; ++i) {
+            Observable* o = deps[i];
+            if (o == skip) continue;
+            std::erase_if(o->waiters_, [this](const Waiter& w) { return w.pred == this; });
+        }
+    }
+
+    void finish(Scheduler& s, Observable* from);
+};
+
+// -----------------------------------------------------------------------------
+// Process - Callback triggered by signal changes
+// -----------------------------------------------------------------------------
+
+struct Process {
+    using Callback = std::function<void(Scheduler&)>;
+    Callback callback;
+    bool always_active;  // Run every delta regardless of triggers
+};
+
+// -----------------------------------------------------------------------------
+// FramePool - Size-class allocator for coroutine frames
+//
+// Each Scheduler opens one, which makes it current for its thread, so
+// frames of coroutines created while it is alive are recycled through
+// per-size free lists instead of the global heap. A small header
+// remembers the owning pool; oversized frames (or frames created with no
+// pool) fall back to operator new.
+//
+// Open pools form a per-thread stack: closing one unlinks it wherever it
+// is, so current is always the newest pool still open, whatever order
+// schedulers are destroyed in. A closed pool is freed once its last
+// frame is, since a coroutine created under one scheduler may be handed
+// to another.
+// -----------------------------------------------------------------------------
+
+class FramePool {
+    static constexpr size_t Granule = 64;
+    static constexpr size_t Classes = 16;        // Pooled up to 1 KiB
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header {
+        FramePool* pool;
+        size_t cls;
+    };
+
+    struct FreeBlock { FreeBlock* next; };
+
+    std::array<FreeBlock*, Classes + 1> free_{};
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::byte* bump_ = nullptr;
+    std::byte* end_ = nullptr;
+
+    FramePool* below_ = nullptr;      // Open pools of this thread, newest on top
+    FramePool* above_ = nullptr;
+    size_t frames_ = 0;               // Frames handed out and not yet returned
+    bool open_ = true;
+
+    FramePool() = default;
+
+    void* take(size_t cls) {
+        if (FreeBlock* b = free_[cls]) {
+            free_[cls] = b->next;
+            return b;
+        }
+        size_t bytes = cls * Granule;
+        if (size_t(end_ - bump_) < bytes) {
+            chunks_.push_back(std::make_unique<std::byte[]>(ChunkSize));
+            bump_ = chunks_.back().get();
+            end_ = bump_ + ChunkSize;
+        }
+        void* p = bump_;
+        bump_ += bytes;
+        return p;
+    }
+
+    void give(void* p, size_t cls) {
+        auto* b = static_cast<FreeBlock*>(p);
+        b->next = free_[cls];
+        free_[cls] = b;
+    }
+
+public:
+    static inline thread_local FramePool* current = nullptr;
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // A new pool, current for this thread until closed or another opens
+    static FramePool* open() {
+        auto* p = new FramePool;
+        p->below_ = current;
+        if (current) current->above_ = p;
+        current = p;
+        return p;
+    }
+
+    // Stop handing out frames; called on the thread that opened the pool
+    void close() {
+        if (above_) above_->below_ = below_;
+        else current = below_;
+        if (below_) below_->above_ = above_;
+        above_ = below_ = nullptr;
+        open_ = false;
+        if (frames_ == 0) delete this;
+    }
+
+    static void* allocate(size_t n) {
+        size_t total = n + sizeof(Header);
+        size_t cls = (total + Granule - 1) / Granule;
+        FramePool* pool = current;
+        Header* h;
+        if (pool && cls <= Classes) {
+            h = static_cast<Header*>(pool->take(cls));
+            ++pool->frames_;
+        } else {
+            h = static_cast<Header*>(::operator new(total));
+            pool = nullptr;
+        }
+        h->pool = pool;
+        h->cls = cls;
+        return h + 1;
+    }
+
+    static void deallocate(void* p) {
+        Header* h = static_cast<Header*>(p) - 1;
+        FramePool* pool = h->pool;
+        if (!pool) {
+            ::operator delete(h);
+            return;
+        }
+        pool->give(h, h->cls);
+        if (--pool->frames_ == 0 && !pool->open_) delete pool;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Arena - Bump allocator for scheduler-owned observables
+//
+// Objects are placed back to back, in allocation order, in cache-line
+// aligned chunks that never move, so handles stay valid and ports of one
+// kind registered together sit together in memory. The owner runs the
+// destructors; the arena only releases the chunks.
+// -----------------------------------------------------------------------------
+
+class Arena {
+    static constexpr size_t Align = 64;
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    struct Release {
+        void operator()(std::byte* p) const { ::operator delete(p, std::align_val_t(Align)); }
+    };
+
+    std::vector<std::unique_ptr<std::byte, Release>> chunks_;
+    std::byte* bump_ = nullptr;
+    std::byte* end_ = nullptr;
+
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t n, size_t align) {
+        auto at = [&] {
+            auto addr = reinterpret_cast<uintptr_t>(bump_);
+            return reinterpret_cast<std::byte*>((addr + align - 1) & ~uintptr_t(align - 1));
+        };
+        std::byte* p = at();
+        if (!bump_ || n > size_t(end_ - p)) {
+            size_t bytes = std::max(ChunkSize, n + align);
+            chunks_.emplace_back(static_cast<std::byte*>(::operator new(bytes, std::align_val_t(Align))));
+            bump_ = chunks_.back().get();
+            end_ = bump_ + bytes;
+            p = at();
+        }
+        bump_ = p + n;
+        return p;
+    }
+
+    template<typename T, typename... Args>
+    T* make(Args&&... args) {
+        return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Veroutine - Coroutine process
+//
+// Lazily started. Either handed to Scheduler::spawn() (the scheduler then
+// owns it and reclaims the frame on completion) or co_awaited from another
+// Veroutine, which resumes when the child returns. Suspended coroutines sit
+// on observable waiter lists or in the timed-event queue and cost nothing
+// until their trigger fires.
+// -----------------------------------------------------------------------------
+
+class Veroutine {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle h) noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        Scheduler* sched = nullptr;
+        std::coroutine_handle<> continuation;  // Awaiting parent
+        size_t* join_pending = nullptr;        // Shared counter when started by all()
+        size_t root = SIZE_MAX;                // Slot in Scheduler roots when spawned
+
+        static void* operator new(size_t n) { return FramePool::allocate(n); }
+        static void operator delete(void* p) { FramePool::deallocate(p); }
+
+        Veroutine get_return_object() { return Veroutine{Handle::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    Veroutine() = default;
+    explicit Veroutine(Handle h) : h_(h) {}
+    Veroutine(Veroutine&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    Veroutine& operator=(Veroutine&& o) noexcept {
+        if (this != &o) { if (h_) h_.destroy(); h_ = std::exchange(o.h_, {}); }
+        return *this;
+    }
+    ~Veroutine() { if (h_) h_.destroy(); }
+
+    Handle handle() const { return h_; }
+    Handle release() { return std::exchange(h_, {}); }
+    bool done() const { return !h_ || h_.done(); }
+
+    // co_await child: run it to completion, then continue the parent
+    struct Awaiter {
+        Handle child;
+        bool await_ready() const noexcept { return !child || child.done(); }
+        std::coroutine_handle<> await_suspend(Handle parent) noexcept {
+            child.promise().sched = parent.promise().sched;
+            child.promise().continuation = parent;
+            return child;
+        }
+        void await_resume() const noexcept {}
+    };
+    Awaiter operator co_await() const& noexcept { return {h_}; }
+
+private:
+    Handle h_;
+};
+
+#if VEROUTINES_PROFILE
+// -----------------------------------------------------------------------------
+// Profile - Scheduler counters (VEROUTINES_PROFILE builds only)
+//
+// Ticks are rdtsc cycles on x86, steady_clock nanoseconds elsewhere.
+// -----------------------------------------------------------------------------
+
+inline uint64_t prof_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct Profile {
+    enum Phase { Advance, Timed, Commit, Eval, Sample, React, Resume, Trace, NumPhases };
+    static constexpr const char* phase_names[NumPhases] = {
+        "advance", "timed", "commit", "eval", "sample", "react", "resume", "trace"};
+
+    uint64_t ticks[NumPhases] = {};
+    uint64_t timesteps = 0;
+    uint64_t deltas = 0;
+    uint64_t max_deltas = 0;        // Most deltas in one timestep
+    uint64_t evals = 0;
+    uint64_t evals_skipped = 0;     // Deltas where need_eval was false
+    uint64_t lookahead = 0;         // Timesteps run as model-only slots
+    uint64_t queue_depth_sum = 0;   // Timed events pending, summed per timestep
+    uint64_t max_queue_depth = 0;
+    std::vector<uint64_t> proc_calls;
+    std::vector<uint64_t> proc_ticks;
+
+    // Charge time since t0 to a phase and restart the stopwatch
+    void lap(Phase p, uint64_t& t0) {
+        uint64_t t = prof_clock();
+        ticks[p] += t - t0;
+        t0 = t;
+    }
+
+    void print(std::ostream& os) const {
+        uint64_t total = 0;
+        for (uint64_t t : ticks) total += t;
+        os << "[Veroutines] Scheduler profile\n";
+        for (int p = 0; p < NumPhases; ++p)
+            os << "  " << std::left << std::setw(8) << phase_names[p] << std::right
+               << std::setw(16) << ticks[p] << " ticks "
+               << std::fixed << std::setprecision(1) << std::setw(6)
+               << (total ? 100.0 * double(ticks[p]) / double(total) : 0.0) << "%\n";
+        os << "  timesteps " << timesteps << ", deltas " << deltas
+           << " (" << std::setprecision(2) << (timesteps ? double(deltas) / double(timesteps) : 0.0)
+           << "/step, max " << max_deltas << ")\n";
+        os << "  evals " << evals << ", skipped " << evals_skipped
+           << ", model-only timesteps " << lookahead << "\n";
+        os << "  timed-event queue depth avg "
+           << (timesteps ? double(queue_depth_sum) / double(timesteps) : 0.0)
+           << ", max " << max_queue_depth << "\n";
+        for (size_t pid = 0; pid < proc_calls.size(); ++pid)
+            if (proc_calls[pid])
+                os << "  process " << std::setw(4) << pid << std::setw(12) << proc_calls[pid]
+                   << " calls " << std::setw(16) << proc_ticks[pid] << " ticks\n";
+    }
+};
+#endif
+
+// -----------------------------------------------------------------------------
+// Tracing - waveform setup helpers
+//
+// Depth and scope filters are applied once, before the file is opened:
+// only signals under `scope` (empty = whole hierarchy) down to `depth`
+// levels are registered. With --trace-fst --trace-threads the FST writer
+// runs on its own thread, so dump() only hands off the changes.
+// -----------------------------------------------------------------------------
+
+struct NoTrace {
+    void dump(uint64_t) {}
+};
+
+struct TraceOptions {
+    int depth = 99;          // Hierarchy levels to register
+    std::string scope;       // Restrict to this sub-hierarchy (e.g. "TOP.axibox")
+};
+
+template<typename TopModel, typename Trace>
+bool open_trace(TopModel* top, Trace* tfp, const char* path, const TraceOptions& opt = {}) {
+    if (!opt.scope.empty()) tfp->dumpvars(opt.depth, opt.scope);
+    top->trace(tfp, opt.depth);
+    tfp->open(path);
+    return tfp->isOpen();
+}
+
+// -----------------------------------------------------------------------------
+// ModelBase - Type-erased Verilated model
+//
+// Lets one Scheduler drive several separately compiled models (e.g. a SoC
+// and a PHY), each with its own context, input ports, output banks and
+// trace file.
+// -----------------------------------------------------------------------------
+
+class ModelBase {
+public:
+    virtual ~ModelBase() = default;
+    virtual void eval() = 0;
+    virtual bool eventsPending() = 0;
+    virtual uint64_t nextTimeSlot() = 0;
+    virtual const void* top() const = 0;
+};
+
+template<typename TopModel>
+class Model final : public ModelBase {
+    TopModel* top_;
+
+public:
+    explicit Model(TopModel* top) : top_(top) {}
+
+    void eval() override { top_->eval(); }
+    bool eventsPending() override { return top_->eventsPending(); }
+    uint64_t nextTimeSlot() override { return top_->nextTimeSlot(); }
+    const void* top() const override { return top_; }
+};
+
+// -----------------------------------------------------------------------------
+// WorkerPool - Persistent threads released together, joined at a barrier
+//
+// run(job) calls job(w) for every worker w; the caller is worker 0 and
+// returns once all workers are done. Idle workers spin briefly, then
+// sleep on the epoch counter, so back-to-back deltas avoid a syscall.
+// -----------------------------------------------------------------------------
+
+class WorkerPool {
+    std::vector<std::thread> threads_;
+    std::atomic<uint64_t> epoch_{0};     // Bumped to release a job
+    std::atomic<size_t> remaining_{0};   // Workers still running it
+    std::atomic<bool> stop_{false};
+    void (*invoke_)(void*, size_t) = nullptr;
+    void* job_ = nullptr;
+
+    static constexpr int Spins = 4096;
+
+public:
+    explicit WorkerPool(size_t workers) {
+        for (size_t w = 1; w < workers; ++w)
+            threads_.emplace_back([this, w] { loop(w); });
+    }
+
+    ~WorkerPool() {
+        stop_.store(true, std::memory_order_relaxed);
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return threads_.size() + 1; }
+
+    template<typename Job>
+    void run(Job& job) {
+        job_ = &job;
+        invoke_ = [](void* j, size_t w) { (*static_cast<Job*>(j))(w); };
+        remaining_.store(threads_.size(), std::memory_order_relaxed);
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+
+        job(0);
+
+        for (int i = 0; remaining_.load(std::memory_order_acquire) != 0; ++i)
+            if (i > Spins) std::this_thread::yield();
+    }
+
+private:
+    void loop(size_t w) {
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t e = epoch_.load(std::memory_order_acquire);
+            for (int i = 0; e == seen && i < Spins; ++i)
+                e = epoch_.load(std::memory_order_acquire);
+            if (e == seen) {
+                epoch_.wait(seen, std::memory_order_acquire);
+                continue;
+            }
+            seen = e;
+            if (stop_.load(std::memory_order_relaxed)) return;
+            invoke_(job_, w);
+            remaining_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// LoopReport - What was still toggling when the delta limit was hit
+//
+// Built only on the failure path, from the changes recorded during the
+// last `history` deltas of the timestep.
+// -----------------------------------------------------------------------------
+
+enum class LoopPolicy : uint8_t {
+    Abort,          // Report and return from run()
+    SkipTimestep,   // Report, drop the pending writes, move on to the next timestep
+    Callback        // Ask on_loop(); it returns true to skip, false to abort
+};
+
+struct LoopReport {
+    struct Entry {
+        Observable* obs;
+        std::string name;     // Given with Scheduler::name(), else kind and index
+        uint32_t toggles;     // Changes within the recorded deltas
+        size_t writer;        // Last writing PID, SIZE_MAX for DUT/timed/coroutine
+    };
+
+    uint64_t time;
+    int deltas;
+    int history;
+    std::vector<Entry> toggled;
+
+    void print(std::ostream& os) const {
+        os << "[Veroutines] Combinational loop at t=" << time << ": no convergence after "
+           << deltas << " deltas\n";
+        os << "[Veroutines]   toggled in the last " << history << " deltas:\n";
+        for (const auto& e : toggled) {
+            os << "[Veroutines]     " << e.name << " x" << e.toggles;
+            if (e.writer != SIZE_MAX) os << ", last written by process " << e.writer;
+            os << "\n";
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Scheduler - 5-phase execution kernel
+//
+// 1. COMMIT   - Apply staged writes, capture edges
+// 2. EVAL     - model.eval() for each model with new inputs or a due event
+// 3. SAMPLE   - Capture DUT outputs
+// 4. REACT    - Trigger and run processes
+// 5. CONVERGE - Loop if dirty, else advance time
+// -----------------------------------------------------------------------------
+
+class Scheduler {
+public:
+    using Action = Veroutines::Action;
+
+private:
+    FramePool* frames_ = FramePool::open();
+
+    TimingWheel time_events_;
+
+    // Observables live in one arena per kind; owned_ is the registration
+    // order across kinds and runs their destructors
+    Arena input_arena_;
+    Arena output_arena_;
+    Arena signal_arena_;
+    std::vector<Observable*> owned_;
+    std::vector<Observable*> inputs_;
+    std::vector<Observable*> outputs_;
+    std::vector<Observable*> signals_;
+    std::vector<std::unique_ptr<HistoryBase>> histories_;
+
+    // Sensitivity graph, frozen into CSR form: every observable's
+    // dependents_ lists laid out back to back, sliced by Observable::deps_
+    std::vector<Observable*> sensitive_;   // Observables with dependents, in first-use order
+    std::vector<uint32_t> sens_;           // PIDs
+    bool frozen_ = false;
+
+    // Registered models. Slot 0 always exists so ports can be created
+    // before run(ctx, top) binds the default model to it.
+    struct ModelSlot {
+        std::unique_ptr<ModelBase> model;
+        VerilatedContext* ctx = nullptr;
+        std::vector<Observable*> dirty_inputs;                 // Commit queue
+        std::vector<std::unique_ptr<OutputBankBase>> banks;    // One per output type
+        void* tfp = nullptr;
+        void (*dump)(void*, uint64_t) = nullptr;
+        uint64_t next_slot = UINT64_MAX;  // nextTimeSlot() as of the last eval, MAX if none
+        bool committed = false;   // An input changed at this delta's commit
+        bool initialized = false; // First eval() done (initial blocks, settle)
+        bool evaluated = false;   // eval() ran this delta
+        bool unsampled = false;   // Evaluated in a lookahead slot that skipped SAMPLE
+    };
+    std::vector<std::unique_ptr<ModelSlot>> models_;
+
+public:
+    // Two processes writing the same port or signal in one parallel delta
+    enum class WriteConflict : uint8_t {
+        LastWriter,     // Highest PID wins, as in a serial REACT
+        Error           // Report both PIDs and stop run()
+    };
+
+    // Returns the time before which run() may go on (see time_gate())
+    using TimeGate = std::function<uint64_t(Scheduler&)>;
+
+private:
+    // Shared by parallel EVAL and REACT; sized for the larger of the two
+    std::unique_ptr<WorkerPool> pool_;
+    size_t eval_threads_ = 1;
+    bool lookahead_ = true;
+    bool lookahead_sample_ = true;
+    bool on_demand_ = false;
+    bool partitioned_ = false;    // Banks currently split into eager and on-demand slots
+    std::vector<size_t> eval_list_;   // Models to evaluate this delta
+
+    size_t react_threads_ = 1;
+    WriteConflict conflict_ = WriteConflict::LastWriter;
+    std::vector<WriteLog> logs_;              // One per REACT worker
+    std::vector<WriteLog::Entry> merged_;
+    std::pair<size_t, size_t> conflict_pids_;  // Last conflict under WriteConflict::Error
+    bool parallel_ = false;                   // Callbacks running on the pool
+    std::mutex mutex_;                        // Guards scheduling while parallel_
+
+    // Commit queues: only observables written since the last commit.
+    // Everything committed is remembered in settling_ so its edge can be
+    // expired at the next commit without visiting untouched observables.
+    std::vector<Observable*> dirty_signals_;
+    std::vector<Observable*> settling_;
+
+    // Observables that changed in the current delta (filled by commit/sample)
+    std::vector<Observable*> changed_;
+
+    std::vector<Process> processes_;
+    std::vector<uint32_t> always_;   // PIDs run every delta
+    std::vector<uint32_t> ready_;    // PIDs triggered this delta, ascending
+    std::vector<uint64_t> triggered_;  // Bit per PID, cleared as ready_ is built
+    uint32_t trig_lo_ = UINT32_MAX;  // Words of triggered_ that may hold bits
+    uint32_t trig_hi_ = 0;
+
+    // Kernel-driven clocks; edges are computed, not queued
+    struct Clock {
+        Observable* port;
+        void (*drive)(Observable*, bool);   // Writes the level as the port's type
+        uint64_t high;    // Ticks spent high
+        uint64_t low;     // Ticks spent low
+        uint64_t next;    // Time of next edge
+        bool level;       // Level driven at next edge
+    };
+    std::vector<Clock> clocks_;
+    uint64_t next_clock_ = UINT64_MAX;
+
+    // Distributed runs: timesteps at or past horizon_ need the gate's approval
+    TimeGate gate_;
+    uint64_t horizon_ = UINT64_MAX;
+
+    // Spawned coroutines still running, and waiters woken this delta
+    std::vector<Veroutine::Handle> roots_;
+    std::vector<std::coroutine_handle<>> resumable_;
+
+    // Trace window: dumps happen only while open. Closing keeps one final
+    // dump of the closing timestep so the waveform ends on settled values.
+    bool tracing_ = true;
+    bool trace_tail_ = false;
+
+    // Delta limit and loop diagnostics
+    int max_deltas_ = 1000;
+    int loop_history_ = 8;
+    LoopPolicy loop_policy_ = LoopPolicy::Abort;
+    std::function<bool(const LoopReport&)> on_loop_;
+    std::vector<std::pair<int, Observable*>> toggles_;  // (delta, observable) near the limit
+    std::unordered_map<const Observable*, std::string> names_;
+
+    VR_PROF(Profile prof_;)
+
+    uint64_t current_time_ = 0;
+    uint64_t timesteps_ = 0;
+    uint64_t deltas_ = 0;
+
+public:
+    Scheduler() {
+        models_.push_back(std::make_unique<ModelSlot>());
+    }
+
+    ~Scheduler() {
+        for (auto h : roots_) h.destroy();
+        for (auto it = owned_.rbegin(); it != owned_.rend(); ++it) (*it)->~Observable();
+        frames_->close();
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // --- Models ---
+
+    // Register a Verilated model; returns the index its ports are created
+    // with. The first model takes index 0, the default for input()/output().
+    template<typename TopModel>
+    size_t model(VerilatedContext* ctx, TopModel* top) {
+        if (models_[0]->model) models_.push_back(std::make_unique<ModelSlot>());
+        size_t id = models_.size() - 1;
+        bind(*models_[id], ctx, top);
+        return id;
+    }
+
+    // Waveform file dumped for a model at the end of every timestep
+    template<typename Trace>
+    void trace(size_t model, Trace* tfp) {
+        auto& m = *models_[model];
+        m.tfp = tfp;
+        m.dump = tfp ? +[](void* p, uint64_t t) { static_cast<Trace*>(p)->dump(t); } : nullptr;
+    }
+
+    size_t models() const { return models_.size(); }
+
+    // Evaluate models on up to n threads (the caller included); 1 = serial.
+    // Inputs are committed before EVAL and models only talk through the
+    // testbench, so the eval() calls of one delta never depend on each
+    // other. When two or more are due, the k-th due model runs on worker
+    // k % n, so the work of a delta is spread evenly whichever models are
+    // due; a delta with one model due evaluates it on the calling thread
+    // rather than waking a worker.
+    void eval_threads(size_t n) {
+        eval_threads_ = std::max<size_t>(n, 1);
+        resize_pool();
+    }
+
+    // Run the processes triggered in one delta on up to n threads. Writes
+    // are staged NBA-style, so callbacks cannot see each other's writes;
+    // they are logged per thread and replayed in PID order afterwards.
+    // Callbacks must not share unsynchronised testbench state. From a
+    // callback they may write ports and signals, and schedule, cancel or
+    // spawn (the relative order of same-time events from different
+    // processes is then unspecified).
+    void react_threads(size_t n, WriteConflict policy = WriteConflict::LastWriter) {
+        react_threads_ = std::max<size_t>(n, 1);
+        conflict_ = policy;
+        logs_.resize(react_threads_);
+        resize_pool();
+    }
+
+    // Timeslots where only a model has work - nothing staged, no clock edge
+    // or timed event due, no always() process - run back to back as eval,
+    // sample and trace dump until an output change would wake a process or
+    // coroutine. Results are identical to the full 5-phase cycle. With
+    // sample = false those slots skip SAMPLE too: outputs are brought up
+    // to date at the next full timeslot, so edges and pulses inside the
+    // batch are never seen. Only for benches that do not watch outputs
+    // between their own events.
+    void lookahead(bool on, bool sample = true) {
+        lookahead_ = on;
+        lookahead_sample_ = sample;
+    }
+
+    // Conservative synchronization with other schedulers. The gate runs
+    // before every timestep and returns a horizon: the next timestep must
+    // start before it, or run() ends. It may block and may schedule timed
+    // events (remote values) before returning.
+    // Lookahead slots run without the gate, up to the last horizon.
+    void time_gate(TimeGate gate) {
+        gate_ = std::move(gate);
+        horizon_ = gate_ ? 0 : UINT64_MAX;
+    }
+
+    // Earliest timed event, clock edge or model timeslot; UINT64_MAX if none
+    uint64_t next_time() const {
+        return std::min({time_events_.next_time(), next_model_time(), next_clock_});
+    }
+
+    // Sample only the outputs some process or coroutine waits on; the
+    // rest are read from the DUT on val(), so SAMPLE costs what is
+    // observed rather than what is registered. The first before(),
+    // changed(), posedge() or negedge() on an on-demand port makes it
+    // eager for good (edges need the previous delta's sample); that
+    // first read is relative to the last delta the port was read in.
+    // Components that read edges call sample_eagerly() up front. A
+    // parallel REACT reads every on-demand output before dispatch and
+    // regroups ports pinned by its callbacks after the barrier.
+    void sample_on_demand(bool on) {
+        on_demand_ = on;
+        frozen_ = false;
+    }
+
+    // --- Registration ---
+
+    template<typename T>
+    InputPort<T>* input(T* dut_ptr, size_t model = 0) {
+        auto* h = input_arena_.make<InputPort<T>>(dut_ptr);
+        h->dirty_list_ = &models_[model]->dirty_inputs;
+        inputs_.push_back(h);
+        owned_.push_back(h);
+        return h;
+    }
+
+    template<typename T>
+    OutputPort<T>* output(T* dut_ptr, size_t model = 0) {
+        auto* h = output_arena_.make<OutputPort<T>>(bank<T>(*models_[model]), dut_ptr);
+        outputs_.push_back(h);
+        owned_.push_back(h);
+        return h;
+    }
+
+    template<typename T>
+    Signal<T>* signal(T initial = T{}) { return signal_of<Signal<T>>(initial); }
+
+    // Register a Signal subclass (e.g. RemotePort); committed like any signal
+    template<typename S, typename... Args>
+    S* signal_of(Args&&... args) {
+        auto* h = signal_arena_.make<S>(std::forward<Args>(args)...);
+        h->dirty_list_ = &dirty_signals_;
+        signals_.push_back(h);
+        owned_.push_back(h);
+        return h;
+    }
+
+    // Keep the last `depth` changes of a port or signal, with their times.
+    // An observable has one ring; asking again returns it. It counts as
+    // observed, so it is sampled eagerly and ends a lookahead run.
+    template<typename P>
+    History<P>* history(P* obs, size_t depth = 64) {
+        if (obs->history_) return static_cast<History<P>*>(obs->history_);
+        auto h = std::make_unique<History<P>>(obs, depth, current_time_);
+        obs->history_ = h.get();
+        obs->awaited();
+        histories_.push_back(std::move(h));
+        return static_cast<History<P>*>(histories_.back().get());
+    }
+
+    void process(std::initializer_list<Sensitivity> sens, Process::Callback cb) {
+        uint32_t pid = uint32_t(processes_.size());
+        processes_.push_back({std::move(cb), false});
+        if (pid % 64 == 0) triggered_.push_back(0);
+        VR_PROF(prof_.proc_calls.push_back(0); prof_.proc_ticks.push_back(0);)
+        for (const auto& s : sens) {
+            Observable* o = s.obs;
+            if (o->dependents_.empty() && o->pos_dependents_.empty() && o->neg_dependents_.empty())
+                sensitive_.push_back(o);
+            o->add_dependent(pid, s.edge);
+        }
+        frozen_ = false;
+    }
+
+    // Lay the sensitivity graph out as one CSR array. run() freezes on
+    // entry, and again after processes registered while it is running.
+    void freeze() {
+        sens_.clear();
+        for (Observable* o : sensitive_) {
+            o->deps_[0] = uint32_t(sens_.size());
+            sens_.insert(sens_.end(), o->dependents_.begin(), o->dependents_.end());
+            o->deps_[1] = uint32_t(sens_.size());
+            sens_.insert(sens_.end(), o->pos_dependents_.begin(), o->pos_dependents_.end());
+            o->deps_[2] = uint32_t(sens_.size());
+            sens_.insert(sens_.end(), o->neg_dependents_.begin(), o->neg_dependents_.end());
+            o->deps_[3] = uint32_t(sens_.size());
+        }
+        if (on_demand_ || partitioned_) {
+            for (auto& m : models_)
+                for (auto& b : m->banks) b->partition(on_demand_ ? &deltas_ : nullptr);
+            partitioned_ = on_demand_;
+        }
+        frozen_ = true;
+    }
+
+    void always(Process::Callback cb) {
+        uint32_t pid = uint32_t(processes_.size());
+        always_.push_back(pid);
+        processes_.push_back({std::move(cb), true});
+        if (pid % 64 == 0) triggered_.push_back(0);
+        VR_PROF(prof_.proc_calls.push_back(0); prof_.proc_ticks.push_back(0);)
+    }
+
+    // Start a coroutine process at the current time; the scheduler owns it
+    void spawn(Veroutine v) {
+        auto h = v.release();
+        if (!h) return;
+        auto lock = guard();
+        h.promise().sched = this;
+        h.promise().root = roots_.size();
+        roots_.push_back(h);
+        time_events_.push(current_time_, [h] { h.resume(); });
+    }
+
+    size_t active_coroutines() const { return roots_.size(); }
+
+    // Totals across all run() calls
+    uint64_t timesteps() const { return timesteps_; }
+    uint64_t deltas() const { return deltas_; }
+
+    // --- Scheduling ---
+
+    uint64_t time() const { return current_time_; }
+
+    TimerId schedule_after(uint64_t delay, Action action) {
+        auto lock = guard();
+        return time_events_.push(current_time_ + delay, std::move(action));
+    }
+
+    TimerId schedule_at(uint64_t t, Action action) {
+        auto lock = guard();
+        return time_events_.push(t, std::move(action));
+    }
+
+    // Remove a pending timed event; false if it already fired
+    bool cancel(TimerId id) {
+        auto lock = guard();
+        return time_events_.cancel(id);
+    }
+
+    // Free-running clock on a DUT input driven 0/1 (Verilator maps 1-bit
+    // inputs to CData, but any narrow type works). Held low until the
+    // first rising edge at time() + phase; duty is the high fraction of
+    // the period, rounded to whole ticks.
+    template<typename T>
+        requires (!is_wide_v<T>)
+    void clock(InputPort<T>* port, uint64_t period, double duty = 0.5, uint64_t phase = 0) {
+        uint64_t high = uint64_t(double(period) * duty + 0.5);
+        high = std::clamp<uint64_t>(high, 1, period > 1 ? period - 1 : 1);
+        uint64_t low = period > high ? period - high : 1;
+
+        auto drive = [](Observable* o, bool level) {
+            static_cast<InputPort<T>*>(o)->write(level ? T(1) : T(0));
+        };
+        port->write(T(0));
+        clocks_.push_back({port, drive, high, low, current_time_ + phase, true});
+        next_clock_ = std::min(next_clock_, current_time_ + phase);
+    }
+
+    // --- Trace windows ---
+    //
+    // trace_on()/trace_off() may be called from processes, coroutines or
+    // timed events, so capture can start on any triggered condition.
+
+    void trace_on() { tracing_ = true; }
+
+    void trace_off() {
+        if (tracing_) trace_tail_ = true;
+        tracing_ = false;
+    }
+
+    bool tracing() const { return tracing_; }
+
+    // Capture from start to stop only; tracing is off until start
+    void trace_window(uint64_t start, uint64_t stop) {
+        if (start > current_time_) {
+            tracing_ = false;
+            schedule_at(start, [this] { trace_on(); });
+        }
+        schedule_at(stop, [this] { trace_off(); });
+    }
+
+    // Capture from now for `duration` ticks (e.g. around a failure)
+    void trace_for(uint64_t duration) {
+        trace_on();
+        schedule_after(duration, [this] { trace_off(); });
+    }
+
+    // Capture while a port/signal is non-zero
+    template<typename Port>
+    void trace_while(Port* enable) {
+        tracing_ = bool(enable->val());
+        process({enable}, [this, enable](Scheduler&) {
+            if (enable->val()) trace_on();
+            else trace_off();
+        });
+    }
+
+    // --- Delta limit ---
+
+    // A timestep that has not converged after `max` deltas is treated as a
+    // combinational loop; the changes of its last `history` deltas are kept
+    // for the report.
+    void delta_limit(int max, LoopPolicy policy = LoopPolicy::Abort, int history = 8) {
+        max_deltas_ = std::max(max, 1);
+        loop_policy_ = policy;
+        loop_history_ = std::clamp(history, 1, max_deltas_);
+    }
+
+    // Decide per loop; return true to skip the timestep, false to abort
+    void on_loop(std::function<bool(const LoopReport&)> cb) {
+        on_loop_ = std::move(cb);
+        loop_policy_ = LoopPolicy::Callback;
+    }
+
+    // Label an observable for diagnostics
+    void name(Observable* o, std::string n) { names_[o] = std::move(n); }
+
+    // --- Checkpoints ---
+    //
+    // Kernel state goes into the same Verilator stream as a --savable model:
+    //
+    //   VerilatedSave os; os.open("prologue.ckpt");
+    //   os << *ctx << *top; sched.save(os);
+    //   ...
+    //   VerilatedRestore is; is.open("prologue.ckpt");
+    //   is >> *ctx >> *top; sched.restore(is);
+    //
+    // Saved: time, counters, every port and signal (staged/value/before and
+    // pending writes), edges still to expire, and clock phases. Timed events
+    // and coroutines are closures and cannot be serialised: restore() drops
+    // pending events, so re-arm them (and spawn) afterwards. The testbench
+    // must register the same ports, signals and clocks in the same order.
+    // For copy-on-write forking of the whole process, see veroutines_fork.h.
+
+    static constexpr uint32_t CheckpointMagic = 0x56524b31;  // "VRK1"
+
+    void save(VerilatedSerialize& os) const {
+        uint64_t n = owned_.size();
+        uint64_t nclocks = clocks_.size();
+        os.write(&CheckpointMagic, sizeof(CheckpointMagic))
+          .write(&current_time_, sizeof(current_time_))
+          .write(&timesteps_, sizeof(timesteps_))
+          .write(&deltas_, sizeof(deltas_))
+          .write(&n, sizeof(n));
+
+        std::unordered_set<const Observable*> settling(settling_.begin(), settling_.end());
+        for (auto& o : owned_) {
+            uint8_t flags = uint8_t(o->dirty_) | uint8_t(settling.count(o)) << 1;
+            os.write(&flags, sizeof(flags));
+            o->save(os);
+        }
+
+        os.write(&nclocks, sizeof(nclocks));
+        for (auto& c : clocks_) {
+            os.write(&c.high, sizeof(c.high)).write(&c.low, sizeof(c.low))
+              .write(&c.next, sizeof(c.next)).write(&c.level, sizeof(c.level));
+        }
+    }
+
+    // False if the checkpoint does not match this testbench; the kernel
+    // state is then unspecified
+    bool restore(VerilatedDeserialize& is) {
+        uint32_t magic = 0;
+        uint64_t n = 0;
+        is.read(&magic, sizeof(magic));
+        if (magic != CheckpointMagic) {
+            std::cerr << "[Veroutines] Not a scheduler checkpoint\n";
+            return false;
+        }
+        uint64_t time, timesteps, deltas;
+        is.read(&time, sizeof(time)).read(&timesteps, sizeof(timesteps))
+          .read(&deltas, sizeof(deltas)).read(&n, sizeof(n));
+        if (n != owned_.size()) {
+            std::cerr << "[Veroutines] Checkpoint has " << n << " observables, testbench has "
+                      << owned_.size() << "\n";
+            return false;
+        }
+
+        current_time_ = time;
+        timesteps_ = timesteps;
+        deltas_ = deltas;
+        time_events_.reset(time);
+
+        for (auto& m : models_) m->dirty_inputs.clear();
+        dirty_signals_.clear();
+        settling_.clear();
+        for (auto& o : owned_) {
+            uint8_t flags = 0;
+            is.read(&flags, sizeof(flags));
+            o->restore(is);
+            o->dirty_ = false;
+            if (flags & 1) o->mark_dirty();
+            if (flags & 2) settling_.push_back(o);
+        }
+
+        uint64_t nclocks = 0;
+        is.read(&nclocks, sizeof(nclocks));
+        if (nclocks != clocks_.size()) {
+            std::cerr << "[Veroutines] Checkpoint has " << nclocks << " clocks, testbench has "
+                      << clocks_.size() << "\n";
+            return false;
+        }
+        next_clock_ = UINT64_MAX;
+        for (auto& c : clocks_) {
+            is.read(&c.high, sizeof(c.high)).read(&c.low, sizeof(c.low))
+              .read(&c.next, sizeof(c.next)).read(&c.level, sizeof(c.level));
+            next_clock_ = std::min(next_clock_, c.next);
+        }
+        return true;
+    }
+
+    // --- Profiling ---
+
+    // Summary of VEROUTINES_PROFILE counters; no-op when compiled out
+    void print_profile(std::ostream& os = std::cout) const {
+        VR_PROF(prof_.print(os);)
+        (void)os;
+    }
+
+    // --- Main Loop ---
+
+    // Single-model entry point: binds `top` as model 0
+    template<typename TopModel, typename Trace = NoTrace>
+    void run(VerilatedContext* ctx, TopModel* top, Trace* tfp = nullptr,
+             uint64_t timeout = UINT64_MAX) {
+        auto& m = *models_[0];
+        if (!m.model || m.model->top() != top) bind(m, ctx, top);
+        trace(0, tfp);
+        run(timeout);
+    }
+
+    // Advance every registered model together until one $finishes,
+    // nothing is left to do, or time reaches `timeout`
+    void run(uint64_t timeout = UINT64_MAX) {
+
+        if (!frozen_) freeze();
+        for (auto& m : models_)
+            if (m->model) refresh_slot(*m);
+        if (tracing_) dump_traces(0);
+
+        while (!finished() && current_time_ < timeout) {
+            VR_PROF(uint64_t t0 = prof_clock();)
+
+            // Model-only slots; a slot that wakes something continues at REACT
+            bool presampled = lookahead_ && run_model_slots(timeout);
+            uint64_t t_next = current_time_;
+
+            if (!presampled) {
+                if (finished() || current_time_ >= timeout) break;
+
+                // Time advancement
+                t_next = next_time();
+                if (gate_) [[unlikely]] {
+                    horizon_ = gate_(*this);
+                    t_next = next_time();
+                    if (t_next >= horizon_) break;
+                }
+                if (t_next == UINT64_MAX) break;
+
+                for (auto& m : models_)
+                    if (m->ctx) m->ctx->time(t_next);
+                current_time_ = t_next;
+                time_events_.advance(t_next);
+                ++timesteps_;
+
+                // Clock edges (stage writes like any timed event)
+                if (next_clock_ == t_next)
+                    fire_clocks();
+
+                VR_PROF(
+                    ++prof_.timesteps;
+                    prof_.queue_depth_sum += time_events_.size();
+                    prof_.max_queue_depth = std::max<uint64_t>(prof_.max_queue_depth, time_events_.size());
+                    prof_.lap(Profile::Advance, t0);
+                )
+
+                // Fire timed events (may stage writes)
+                for (Action ev; time_events_.pop(ev);)
+                    ev();
+                VR_PROF(prof_.lap(Profile::Timed, t0);)
+            }
+
+            // Delta convergence loop
+            int delta = 0;
+            const int watch = max_deltas_ - loop_history_;
+            toggles_.clear();
+            while (true) {
+                if (!presampled) {
+                    // PHASE 1: COMMIT
+                    for (auto* p : settling_) p->settle();
+                    settling_.clear();
+
+                    for (auto& m : models_)
+                        m->committed = commit_queue(m->dirty_inputs);
+                    commit_queue(dirty_signals_);
+                    VR_PROF(prof_.lap(Profile::Commit, t0);)
+
+                    // PHASE 2: EVAL
+                    // A model whose inputs did not change and that has no event
+                    // of its own due is left alone, so idle timeslots cost no eval.
+                    for (size_t i = 0; i < models_.size(); ++i) {
+                        auto& m = models_[i];
+                        if (!m->model) continue;
+                        m->evaluated = !m->initialized || m->committed || m->next_slot <= t_next;
+                        m->initialized = true;
+                        if (m->evaluated) eval_list_.push_back(i);
+                        VR_PROF(
+                            if (m->evaluated) ++prof_.evals;
+                            else ++prof_.evals_skipped;
+                        )
+                    }
+                    eval_models();
+                    VR_PROF(prof_.lap(Profile::Eval, t0);)
+
+                    // PHASE 3: SAMPLE
+                    // Banks of skipped models are resampled only to expire edges
+                    for (auto& m : models_) {
+                        for (auto& b : m->banks)
+                            if (m->evaluated || m->unsampled || b->pending()) b->sample(changed_);
+                        m->unsampled = false;
+                    }
+                    VR_PROF(prof_.lap(Profile::Sample, t0);)
+                }
+                presampled = false;
+
+                // PHASE 4: REACT
+                if (delta > watch) [[unlikely]]
+                    for (auto* o : changed_) toggles_.emplace_back(delta, o);
+
+                if (!frozen_) [[unlikely]] freeze();
+                const uint32_t* sens = sens_.data();
+                for (auto* o : changed_) {
+                    if (o->history_) [[unlikely]] o->history_->record(current_time_);
+                    const uint32_t* d = o->deps_;
+                    for (uint32_t i = d[0]; i < d[1]; ++i) trigger(sens[i]);
+                    if (d[1] != d[2] && o->rose())
+                        for (uint32_t i = d[1]; i < d[2]; ++i) trigger(sens[i]);
+                    if (d[2] != d[3] && o->fell())
+                        for (uint32_t i = d[2]; i < d[3]; ++i) trigger(sens[i]);
+                    if (!o->waiters_.empty())
+                        wake_waiters(o);
+                }
+                changed_.clear();
+
+                for (uint32_t pid : always_) trigger(pid);
+
+                // Run in PID order, independent of trigger order
+                collect_ready();
+                bool merged = true;
+                if (react_threads_ > 1 && ready_.size() > 1) {
+                    merged = react_parallel();
+                } else {
+                    for (uint32_t pid : ready_) run_process(pid);
+                }
+                ready_.clear();
+                VR_PROF(prof_.lap(Profile::React, t0);)
+
+                // Coroutines resume after callbacks, in wake order; also
+                // after a conflict, so none is left woken but suspended
+                for (size_t i = 0; i < resumable_.size(); ++i)
+                    resumable_[i].resume();
+                resumable_.clear();
+                VR_PROF(prof_.lap(Profile::Resume, t0);)
+
+                if (!merged) [[unlikely]] {
+                    std::cerr << "[Veroutines] Write conflict at t=" << current_time_ << ": processes "
+                              << conflict_pids_.first << " and " << conflict_pids_.second
+                              << " wrote the same observable\n";
+                    return;
+                }
+
+                // PHASE 5: CONVERGENCE
+                ++deltas_;
+                VR_PROF(++prof_.deltas;)
+                if (!inputs_dirty() && dirty_signals_.empty())
+                    break;
+
+                if (++delta > max_deltas_) {
+                    if (!delta_limit_hit(delta - 1)) return;
+                    break;
+                }
+            }
+
+            VR_PROF(prof_.max_deltas = std::max<uint64_t>(prof_.max_deltas, uint64_t(delta) + 1);)
+
+            if (tracing_ || trace_tail_) {
+                dump_traces(t_next);
+                trace_tail_ = false;
+            }
+            VR_PROF(prof_.lap(Profile::Trace, t0);)
+        }
+    }
+
+private:
+    void fire_clocks() {
+        uint64_t next = UINT64_MAX;
+        for (auto& c : clocks_) {
+            if (c.next == current_time_) {
+                c.drive(c.port, c.level);
+                c.next += c.level ? c.high : c.low;
+                c.level = !c.level;
+            }
+            next = std::min(next, c.next);
+        }
+        next_clock_ = next;
+    }
+
+    template<typename TopModel>
+    static void bind(ModelSlot& m, VerilatedContext* ctx, TopModel* top) {
+        m.model = std::make_unique<Model<TopModel>>(top);
+        m.ctx = ctx;
+    }
+
+    bool finished() const {
+        for (auto& m : models_)
+            if (m->ctx && m->ctx->gotFinish()) return true;
+        return false;
+    }
+
+    uint64_t next_model_time() const {
+        uint64_t t = UINT64_MAX;
+        for (auto& m : models_)
+            if (m->model) t = std::min(t, m->next_slot);
+        return t;
+    }
+
+    // A model's next timeslot only moves when it is evaluated
+    static void refresh_slot(ModelSlot& m) {
+        m.next_slot = m.model->eventsPending() ? m.model->nextTimeSlot() : UINT64_MAX;
+    }
+
+    // Lookahead fast path (see lookahead()). Returns true if it stopped on
+    // a slot whose output changes wake something: that slot is evaluated
+    // and sampled, and changed_ is left for REACT.
+    bool run_model_slots(uint64_t timeout) {
+        if (!always_.empty() || inputs_dirty() || !dirty_signals_.empty()) return false;
+        for (auto& m : models_)
+            if (m->model && !m->initialized) return false;
+
+        while (!finished() && current_time_ < timeout) {
+            uint64_t t = next_model_time();
+            if (t == UINT64_MAX || t >= time_events_.next_time() || t >= next_clock_ || t >= horizon_)
+                return false;
+
+            for (auto& m : models_)
+                if (m->ctx) m->ctx->time(t);
+            current_time_ = t;
+            time_events_.advance(t);
+            ++timesteps_;
+            VR_PROF(++prof_.timesteps; ++prof_.lookahead;)
+
+            for (auto* p : settling_) p->settle();
+            settling_.clear();
+
+            for (size_t i = 0; i < models_.size(); ++i) {
+                auto& m = models_[i];
+                m->evaluated = m->model && m->next_slot <= t;
+                if (m->evaluated) eval_list_.push_back(i);
+                VR_PROF(
+                    if (m->evaluated) ++prof_.evals;
+                    else if (m->model) ++prof_.evals_skipped;
+                )
+            }
+            eval_models();
+
+            if (lookahead_sample_) {
+                for (auto& m : models_)
+                    for (auto& b : m->banks)
+                        if (m->evaluated || b->pending()) b->sample(changed_);
+                if (wakes_any()) return true;
+                changed_.clear();
+            } else {
+                for (auto& m : models_) m->unsampled |= m->evaluated;
+            }
+            ++deltas_;
+            VR_PROF(++prof_.deltas;)
+
+            if (tracing_ || trace_tail_) {
+                dump_traces(t);
+                trace_tail_ = false;
+            }
+        }
+        return false;
+    }
+
+    // Would REACT have anything to do for the observables in changed_?
+    bool wakes_any() const {
+        for (auto* o : changed_) {
+            const uint32_t* d = o->deps_;
+            if (d[0] != d[1] || !o->waiters_.empty() || o->history_) return true;
+            if (d[1] != d[2] && o->rose()) return true;
+            if (d[2] != d[3] && o->fell()) return true;
+        }
+        return false;
+    }
+
+    void resize_pool() {
+        size_t n = std::max(eval_threads_, react_threads_);
+        if (n == 1) pool_.reset();
+        else if (!pool_ || pool_->size() != n) pool_ = std::make_unique<WorkerPool>(n);
+    }
+
+    // Lock for scheduling calls made from parallel callbacks
+    std::unique_lock<std::mutex> guard() {
+        return parallel_ ? std::unique_lock(mutex_) : std::unique_lock<std::mutex>();
+    }
+
+    // Serial, or one pool dispatch with a barrier before SAMPLE
+    void eval_models() {
+        if (eval_threads_ < 2 || eval_list_.size() < 2) {
+            for (size_t i : eval_list_) {
+                models_[i]->model->eval();
+                refresh_slot(*models_[i]);
+            }
+        } else {
+            const size_t n = eval_threads_;
+            auto job = [this, n](size_t w) {
+                if (w >= n) return;
+                for (size_t k = w; k < eval_list_.size(); k += n) {
+                    ModelSlot& m = *models_[eval_list_[k]];
+                    m.model->eval();
+                    refresh_slot(m);
+                }
+            };
+            pool_->run(job);
+        }
+        eval_list_.clear();
+    }
+
+    void run_process(size_t pid) {
+        VR_PROF(uint64_t tp = prof_clock();)
+        Observable::running_ = pid;
+        processes_[pid].callback(*this);
+        Observable::running_ = SIZE_MAX;
+        VR_PROF(++prof_.proc_calls[pid]; prof_.proc_ticks[pid] += prof_clock() - tp;)
+    }
+
+    // Report a timestep stuck past the delta limit; false to leave run()
+    bool delta_limit_hit(int deltas) {
+        LoopReport r{current_time_, deltas, loop_history_, {}};
+        std::unordered_map<Observable*, size_t> index;
+        for (auto [d, o] : toggles_) {
+            auto [it, fresh] = index.emplace(o, r.toggled.size());
+            if (fresh) r.toggled.push_back({o, describe(o), 0, o->last_writer_});
+            ++r.toggled[it->second].toggles;
+        }
+        toggles_.clear();
+
+        bool skip = loop_policy_ == LoopPolicy::SkipTimestep;
+        if (loop_policy_ == LoopPolicy::Callback && on_loop_) skip = on_loop_(r);
+        else r.print(std::cerr);
+        if (!skip) return false;
+
+        // Writes still pending belong to the oscillation; drop them
+        for (auto& m : models_) drop_queue(m->dirty_inputs);
+        drop_queue(dirty_signals_);
+        return true;
+    }
+
+    static void drop_queue(std::vector<Observable*>& queue) {
+        for (auto* o : queue) o->dirty_ = false;
+        queue.clear();
+    }
+
+    std::string describe(const Observable* o) const {
+        if (auto it = names_.find(o); it != names_.end()) return it->second;
+        auto find = [o](const std::vector<Observable*>& v, const char* kind) -> std::string {
+            auto it = std::find(v.begin(), v.end(), o);
+            return it == v.end() ? "" : kind + std::to_string(it - v.begin());
+        };
+        for (auto n : {find(inputs_, "input "), find(outputs_, "output "), find(signals_, "signal ")})
+            if (!n.empty()) return n;
+        return "observable";
+    }
+
+    // Workers claim ready PIDs from a shared index until none are left;
+    // then the logged writes are replayed in PID order. False on a
+    // conflict under WriteConflict::Error, found before any write is
+    // applied; run() reports it once woken coroutines have resumed.
+    bool react_parallel() {
+        std::atomic<size_t> next{0};
+        auto job = [this, &next](size_t w) {
+            if (w >= react_threads_) return;
+            WriteLog& log = logs_[w];
+            WriteLog::active = &log;
+            for (size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < ready_.size();) {
+                log.pid = ready_[k];
+                run_process(log.pid);
+            }
+            WriteLog::active = nullptr;
+        };
+        // Callbacks on workers must find on-demand slots read-only
+        if (partitioned_)
+            for (auto& m : models_)
+                for (auto& b : m->banks) b->refresh();
+        parallel_ = true;
+        pool_->run(job);
+        parallel_ = false;
+        if (partitioned_)
+            for (auto& m : models_)
+                for (auto& b : m->banks) b->settle();
+
+        // Each process ran on one worker, so a stable sort keeps its
+        // writes in program order
+        for (auto& log : logs_) {
+            std::move(log.entries.begin(), log.entries.end(), std::back_inserter(merged_));
+            log.entries.clear();
+        }
+        std::stable_sort(merged_.begin(), merged_.end(),
+                         [](const auto& a, const auto& b) { return a.pid < b.pid; });
+
+        bool ok = true;
+        if (conflict_ == WriteConflict::Error) {
+            for (auto& e : merged_) {
+                if (e.obs->writer_ != SIZE_MAX && e.obs->writer_ != e.pid) {
+                    conflict_pids_ = {e.obs->writer_, e.pid};
+                    ok = false;
+                    break;
+                }
+                e.obs->writer_ = e.pid;
+            }
+            for (auto& e : merged_) e.obs->writer_ = SIZE_MAX;
+        }
+        if (ok) {
+            for (auto& e : merged_) {
+                Observable::running_ = e.pid;
+                e.apply();
+                Observable::running_ = SIZE_MAX;
+            }
+        }
+        merged_.clear();
+        return ok;
+    }
+
+    bool inputs_dirty() const {
+        for (auto& m : models_)
+            if (!m->dirty_inputs.empty()) return true;
+        return false;
+    }
+
+    void dump_traces(uint64_t t) {
+        for (auto& m : models_)
+            if (m->dump) m->dump(m->tfp, t);
+    }
+
+    template<typename T>
+    OutputBank<T>* bank(ModelSlot& m) {
+        for (auto& b : m.banks)
+            if (auto* typed = dynamic_cast<OutputBank<T>*>(b.get())) return typed;
+        m.banks.push_back(std::make_unique<OutputBank<T>>());
+        return static_cast<OutputBank<T>*>(m.banks.back().get());
+    }
+
+    // True if any queued observable actually changed value
+    bool commit_queue(std::vector<Observable*>& queue) {
+        bool any = false;
+        for (auto* p : queue) {
+            if (p->commit()) {
+                changed_.push_back(p);
+                any = true;
+            }
+            settling_.push_back(p);
+        }
+        queue.clear();
+        return any;
+    }
+
+    void trigger(uint32_t pid) {
+        uint32_t w = pid / 64;
+        triggered_[w] |= uint64_t(1) << (pid % 64);
+        trig_lo_ = std::min(trig_lo_, w);
+        trig_hi_ = std::max(trig_hi_, w);
+    }
+
+    // Drain the triggered bits into ready_, which comes out sorted
+    void collect_ready() {
+        if (trig_lo_ > trig_hi_) return;
+        for (uint32_t w = trig_lo_; w <= trig_hi_; ++w) {
+            uint64_t bits = std::exchange(triggered_[w], 0);
+            for (; bits; bits &= bits - 1)
+                ready_.push_back(w * 64 + uint32_t(std::countr_zero(bits)));
+        }
+        trig_lo_ = UINT32_MAX;
+        trig_hi_ = 0;
+    }
+
+    void wake_waiters(Observable* o) {
+        const bool rose = o->rose();
+        const bool fell = o->fell();
+        auto& ws = o->waiters_;
+        size_t keep = 0;
+        for (size_t i = 0; i < ws.size(); ++i) {
+            Waiter w = ws[i];
+            if (w.pred) {
+                if (w.pred->done) continue;          // Duplicate entry, already finished
+                if (w.pred->check(w.pred->ctx)) {
+                    w.pred->finish(*this, o);
+                    resumable_.push_back(w.handle);
+                    continue;
+                }
+                ws[keep++] = w;
+                continue;
+            }
+            bool hit = w.edge == Edge::Any || (w.edge == Edge::Pos ? rose : fell);
+            if (hit && --w.remaining == 0) resumable_.push_back(w.handle);
+            else ws[keep++] = w;
+        }
+        ws.resize(keep);
+    }
+
+    void retire(Veroutine::Handle h) {
+        size_t slot = h.promise().root;
+        roots_[slot] = roots_.back();
+        roots_[slot].promise().root = slot;
+        roots_.pop_back();
+        h.destroy();
+    }
+
+    friend struct Veroutine::FinalAwaiter;
+};
+
+// -----------------------------------------------------------------------------
+// Coroutine awaitables
+//
+//   co_await posedge(clk);          // one-shot waiter on the observable
+//   co_await cycles(clk, 10);       // n rising edges
+//   co_await delay(100);            // timed-event queue
+//   co_await all(a(), b(), c());    // fork/join children
+// -----------------------------------------------------------------------------
+
+inline std::coroutine_handle<> Veroutine::FinalAwaiter::await_suspend(Handle h) noexcept {
+    auto& p = h.promise();
+    if (p.join_pending)
+        return --*p.join_pending == 0 ? p.continuation : std::noop_coroutine();
+    if (p.continuation)
+        return p.continuation;
+    if (p.root != SIZE_MAX)
+        p.sched->retire(h);
+    return std::noop_coroutine();
+}
+
+struct EdgeAwaiter {
+    Observable* obs;
+    Edge edge;
+    uint32_t count;
+
+    bool await_ready() const noexcept { return count == 0; }
+    void await_suspend(std::coroutine_handle<> h) {
+        obs->waiters_.push_back({h, edge, count});
+        obs->awaited();
+    }
+    void await_resume() const noexcept {}
+};
+
+inline EdgeAwaiter operator co_await(Sensitivity s) { return {s.obs, s.edge, 1}; }
+
+inline EdgeAwaiter cycles(Observable* clk, uint32_t n) { return {clk, Edge::Pos, n}; }
+
+struct DelayAwaiter {
+    uint64_t ticks;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(Veroutine::Handle h) {
+        h.promise().sched->schedule_after(ticks, [h] { h.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+inline DelayAwaiter delay(uint64_t ticks) { return {ticks}; }
+
+template<size_t N>
+struct JoinAwaiter {
+    std::array<Veroutine, N> children;
+    size_t pending = N + 1;  // +1 held by await_suspend while starting children
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(Veroutine::Handle parent) {
+        for (auto& c : children) {
+            auto& p = c.handle().promise();
+            p.sched = parent.promise().sched;
+            p.continuation = parent;
+            p.join_pending = &pending;
+        }
+        for (auto& c : children) c.handle().resume();
+        return --pending != 0;
+    }
+    void await_resume() const noexcept {}
+};
+
+template<typename... Ts>
+    requires (std::is_same_v<Ts, Veroutine> && ...)
+JoinAwaiter<sizeof...(Ts)> all(Ts&&... children) {
+    return {{std::move(children)...}};
+}
+
+// -----------------------------------------------------------------------------
+// Predicate waits
+//
+//   co_await until([&]{ return !rst->val(); }, rst);
+//   bool ok = co_await timeout([&]{ return s_tready->val(); }, 100, s_tready);
+//
+// The predicate is re-evaluated only when one of the listed observables
+// changes, never per tick. A timeout arms one timed event, which is
+// cancelled as soon as the predicate is satisfied.
+// -----------------------------------------------------------------------------
+
+inline void PredicateWait::finish(Scheduler& s, Observable* from) {
+    done = true;
+    satisfied = true;
+    disarm(from);
+    if (timed) s.cancel(timer);
+}
+
+template<typename Pred, size_t N>
+struct PredicateAwaiter {
+    Pred pred;
+    std::array<Observable*, N> deps;
+    uint64_t ticks;
+    PredicateWait wait;
+
+    PredicateAwaiter(Pred p, std::array<Observable*, N> d, bool timed, uint64_t n = 0)
+        : pred(std::move(p)), deps(d), ticks(n) {
+        wait.timed = timed;
+    }
+
+    bool await_ready() {
+        wait.satisfied = pred();
+        return wait.satisfied;
+    }
+
+    void await_suspend(Veroutine::Handle h) {
+        wait.handle = h;
+        wait.check = [](void* p) -> bool { return (*static_cast<Pred*>(p))(); };
+        wait.ctx = &pred;
+        wait.deps = deps.data();
+        wait.ndeps = N;
+        wait.arm();
+        if (wait.timed) {
+            PredicateWait* w = &wait;
+            wait.timer = h.promise().sched->schedule_after(ticks, [w] {
+                w->done = true;
+                w->disarm(nullptr);
+                w->handle.resume();
+            });
+        }
+    }
+
+    bool await_resume() const noexcept { return wait.satisfied; }
+};
+
+// Resume once pred() holds; re-checked only when a dep changes
+template<typename Pred, typename... Deps>
+PredicateAwaiter<Pred, sizeof...(Deps)> until(Pred pred, Deps*... deps) {
+    static_assert(sizeof...(Deps) > 0, "until() needs the observables pred() reads, "
+                                        "or it is never re-checked");
+    return {std::move(pred), {deps...}, false};
+}
+
+// As until(), but gives up after `ticks`; yields true if pred() was satisfied
+template<typename Pred, typename... Deps>
+PredicateAwaiter<Pred, sizeof...(Deps)> timeout(Pred pred, uint64_t ticks, Deps*... deps) {
+    return {std::move(pred), {deps...}, true, ticks};
+}
 
 } // namespace Veroutines
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// Assertions - Clocked temporal checks over history rings
+//
+// Properties are evaluated once per rising edge of clk, on values sampled
+// just before the edge (as SVA does). watch() attaches a History ring to a
+// port or signal; the returned handle reads sampled values by cycle, so a
+// check looks back through recorded changes instead of a per-cycle copy:
+//
+//   Assertions chk(sched, clk);
+//   auto valid = chk.watch(tvalid), ready = chk.watch(tready), data = chk.watch(tdata);
+//   chk.disable_iff([=] { return rst->val(); });
+//   chk.always("tdata stable while stalled",
+//              [=] { return !(valid.past(1) && !ready.past(1)) || data.stable_for(1); });
+//   chk.eventually_within("tready within 16 cycles",
+//                         [=] { return valid.rose(); }, [=] { return ready.now(); }, 16);
+//   ...
+//   chk.finish();
+//
+// Edges and histories are kept `depth` deep. Looking back `depth` cycles
+// or more fails the property doing it, with a one-time report; a lookback
+// past the `depth` changes a ring still holds fails stable_for() and reads
+// the oldest retained value.
+// -----------------------------------------------------------------------------
+
+class Assertions {
+public:
+    struct Failure {
+        const char* name;
+        uint64_t time;            // Edge at which it failed (or finish())
+        uint64_t trigger_time;    // eventually_within: edge that started it
+    };
+
+    using FailCallback = std::function<void(const Failure&)>;
+
+    struct Config {
+        size_t depth = 64;                  // History entries and edges kept
+        size_t max_reports = 16;            // Printed when there is no callback
+    };
+
+    // Sampled view of one watched observable
+    template<typename P>
+    class Sampled {
+        const History<P>* h_ = nullptr;
+        const Assertions* a_ = nullptr;
+
+    public:
+        using T = typename History<P>::T;
+
+        Sampled() = default;
+        Sampled(const History<P>* h, const Assertions* a) : h_(h), a_(a) {}
+
+        // Value sampled k edges before the current one
+        const T& past(size_t k) const { return h_->before(a_->edge(k)); }
+        const T& now() const { return past(0); }
+
+        bool rose() const requires (!is_wide_v<T>) { return !past(1) && now(); }
+        bool fell() const requires (!is_wide_v<T>) { return past(1) && !now(); }
+        bool changed() const { return differs(past(1), now()); }
+
+        // Same sampled value at this edge and the n before it
+        bool stable_for(size_t n) const { return h_->stable(a_->edge(n), a_->edge(0)); }
+
+        const History<P>& history() const { return *h_; }
+    };
+
+private:
+    struct Always {
+        const char* name;
+        std::function<bool()> prop;
+    };
+
+    struct Eventually {
+        const char* name;
+        std::function<bool()> trigger;
+        std::function<bool()> cond;
+        size_t within;
+        std::vector<uint64_t> open;         // Ring of trigger cycles not yet satisfied
+        size_t head = 0;
+        size_t count = 0;
+    };
+
+    Scheduler& sched_;
+    size_t depth_;
+    size_t max_reports_;
+    FailCallback fail_;
+    std::function<bool()> disable_;
+
+    std::vector<uint64_t> edges_;           // Ring of edge times, by cycle
+    uint64_t cycle_ = 0;                    // Edges seen
+    mutable size_t too_deep_ = 0;           // Deepest lookback past depth_ in this check, or 0
+    bool deep_reported_ = false;
+
+    std::vector<Always> always_;
+    std::vector<Eventually> eventually_;
+
+    uint64_t checks_ = 0;
+    uint64_t failures_ = 0;
+
+public:
+    template<typename C>
+    Assertions(Scheduler& s, C* clk, Config cfg = {}, FailCallback cb = nullptr)
+        : sched_(s), depth_(std::max<size_t>(cfg.depth, 2)), max_reports_(cfg.max_reports),
+          fail_(std::move(cb)), edges_(depth_, 0) {
+        s.process({posedge(clk)}, [this](Scheduler& s) { on_edge(s.time()); });
+    }
+
+    Assertions(const Assertions&) = delete;
+    Assertions& operator=(const Assertions&) = delete;
+
+    template<typename P>
+    Sampled<P> watch(P* obs) { return {sched_.history(obs, depth_), this}; }
+
+    // Skip evaluation on edges where cond holds (sampled like the properties)
+    void disable_iff(std::function<bool()> cond) { disable_ = std::move(cond); }
+
+    // prop must hold at every edge
+    void always(const char* name, std::function<bool()> prop) {
+        always_.push_back({name, std::move(prop)});
+    }
+
+    // Once trigger holds at an edge, cond must hold at that edge or one of
+    // the next n. Each triggering edge is its own attempt; one edge where
+    // cond holds satisfies every open attempt.
+    void eventually_within(const char* name, std::function<bool()> trigger,
+                           std::function<bool()> cond, size_t n) {
+        eventually_.push_back({name, std::move(trigger), std::move(cond), n,
+                               std::vector<uint64_t>(n + 1)});
+    }
+
+    // Fail attempts still open; true if nothing failed
+    bool finish() {
+        for (auto& e : eventually_) {
+            for (; e.count; --e.count, e.head = (e.head + 1) % e.open.size())
+                fail(e.name, sched_.time(), time_of(e.open[e.head]));
+        }
+        return passed();
+    }
+
+    uint64_t cycles() const { return cycle_; }
+    uint64_t checks() const { return checks_; }
+    uint64_t failures() const { return failures_; }
+    bool passed() const { return failures_ == 0; }
+
+    void print(std::ostream& os) const {
+        os << "[Veroutines] Assertions: " << checks_ << " checks over " << cycle_ << " cycles, "
+           << failures_ << " failed\n";
+    }
+
+private:
+    // Time of the edge k cycles before the current one; before the first
+    // edge reads the first. Past the ring, flags the running check.
+    uint64_t edge(size_t k) const {
+        if (k >= depth_) [[unlikely]] {
+            too_deep_ = std::max(too_deep_, k);
+            k = depth_ - 1;
+        }
+        k = std::min<uint64_t>(k, cycle_ ? cycle_ - 1 : 0);
+        return edges_[(cycle_ - 1 - k) % depth_];
+    }
+
+    // True (and reported once) if the check just run looked back too far
+    bool too_deep(const char* name) {
+        if (!too_deep_) return false;
+        if (!deep_reported_) {
+            std::cerr << "[Veroutines] Assertion '" << name << "' looks back " << too_deep_
+                      << " cycles; depth is " << depth_ << "\n";
+            deep_reported_ = true;
+        }
+        too_deep_ = 0;
+        return true;
+    }
+
+    // Time of edge number `cycle`, if still in the ring
+    uint64_t time_of(uint64_t cycle) const {
+        return cycle + depth_ >= cycle_ ? edges_[cycle % depth_] : 0;
+    }
+
+    void on_edge(uint64_t now) {
+        edges_[cycle_ % depth_] = now;
+        ++cycle_;
+        if (disable_ && disable_()) {
+            for (auto& e : eventually_) e.count = 0;
+            return;
+        }
+
+        too_deep_ = 0;
+        for (auto& a : always_) {
+            ++checks_;
+            bool ok = a.prop();
+            if (too_deep(a.name) || !ok) fail(a.name, now, now);
+        }
+
+        const uint64_t c = cycle_ - 1;
+        for (auto& e : eventually_) {
+            ++checks_;
+            bool cond = e.cond();
+            bool trigger = !cond && e.trigger();
+            if (too_deep(e.name)) {
+                fail(e.name, now, now);
+            } else if (cond) {
+                e.count = 0;
+                continue;
+            } else if (trigger) {
+                e.open[(e.head + e.count) % e.open.size()] = c;
+                ++e.count;
+            }
+            if (e.count && c - e.open[e.head] >= e.within) {
+                fail(e.name, now, time_of(e.open[e.head]));
+                e.head = (e.head + 1) % e.open.size();
+                --e.count;
+            }
+        }
+    }
+
+    void fail(const char* name, uint64_t time, uint64_t trigger_time) {
+        ++failures_;
+        if (fail_) {
+            fail_({name, time, trigger_time});
+            return;
+        }
+        if (failures_ > max_reports_) return;
+        std::cerr << "[Veroutines] Assertion '" << name << "' failed at t=" << time;
+        if (trigger_time != time) std::cerr << " (triggered at t=" << trigger_time << ")";
+        std::cerr << "\n";
+        if (failures_ == max_reports_)
+            std::cerr << "[Veroutines] Further assertion failures suppressed\n";
+    }
+};
+
+} // namespace Veroutines
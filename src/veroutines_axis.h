@@ -0,0 +1,210 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// AXI-Stream components
+//
+// Transaction-level source and sink built on ports and Scheduler::process.
+// Both run on the rising clock edge and use the values that were present
+// before the edge for the handshake (staged writes land after the edge, so
+// they behave like nonblocking assignments). No allocation or I/O per beat.
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// AxiStreamSource<T> - Drives whole packets into a DUT slave interface
+//
+// send() queues a span into a fixed ring of descriptors; the data is not
+// copied and must stay valid until packets_sent() moves past it.
+// -----------------------------------------------------------------------------
+
+template<typename T>
+class AxiStreamSource {
+public:
+    struct Ports {
+        InputPort<CData>* tvalid;
+        InputPort<T>* tdata;
+        OutputPort<CData>* tready;
+        InputPort<CData>* tlast = nullptr;   // Optional
+        InputPort<CData>* rst = nullptr;     // Optional, active high
+    };
+
+private:
+    Ports p_;
+    std::vector<std::span<const T>> ring_;  // Queued packets
+    size_t head_ = 0;                       // Packet being sent
+    size_t count_ = 0;
+    size_t beat_ = 0;                       // Next beat within head packet
+    bool driving_ = false;                  // A beat is on the bus
+    uint64_t beats_ = 0;
+    uint64_t packets_ = 0;
+
+public:
+    AxiStreamSource(Scheduler& s, Observable* clk, Ports p, size_t capacity = 1024)
+        : p_(p), ring_(capacity) {
+        p_.tready->sample_eagerly();
+        s.process({posedge(clk)}, [this](Scheduler&) { on_clock(); });
+    }
+
+    // Queue a packet; false if the ring is full
+    bool send(std::span<const T> packet) {
+        if (count_ == ring_.size() || packet.empty()) return false;
+        ring_[(head_ + count_) % ring_.size()] = packet;
+        ++count_;
+        return true;
+    }
+
+    bool full() const { return count_ == ring_.size(); }
+    bool idle() const { return count_ == 0 && !driving_; }
+    size_t pending() const { return count_; }
+    uint64_t beats_sent() const { return beats_; }
+    uint64_t packets_sent() const { return packets_; }
+
+private:
+    void on_clock() {
+        if (p_.rst && p_.rst->val()) {
+            if (driving_) p_.tvalid->write(0);
+            driving_ = false;
+            return;
+        }
+
+        // Handshake happened at this edge if valid was driven and ready was high
+        if (driving_ && p_.tready->before()) {
+            ++beats_;
+            if (++beat_ == ring_[head_].size()) {
+                beat_ = 0;
+                head_ = (head_ + 1) % ring_.size();
+                --count_;
+                ++packets_;
+            }
+            driving_ = false;
+        }
+
+        if (!driving_) {
+            if (count_ == 0) {
+                p_.tvalid->write(0);
+                return;
+            }
+            const auto& pkt = ring_[head_];
+            p_.tdata->write(pkt[beat_]);
+            if (p_.tlast) p_.tlast->write(beat_ + 1 == pkt.size());
+            p_.tvalid->write(1);
+            driving_ = true;
+        }
+    }
+};
+
+// -----------------------------------------------------------------------------
+// AxiStreamSink<T> - Collects packets from a DUT master interface
+//
+// Beats go into one preallocated buffer; completed packets are handed to
+// the callback as contiguous spans in batches of `batch`, after which the
+// buffer is reused. Spans are only valid during the callback. Without a
+// tlast port, every `packet_beats` beats form a packet.
+// -----------------------------------------------------------------------------
+
+template<typename T>
+class AxiStreamSink {
+public:
+    struct Ports {
+        OutputPort<CData>* tvalid;
+        OutputPort<T>* tdata;
+        InputPort<CData>* tready;
+        OutputPort<CData>* tlast = nullptr;  // Optional
+        InputPort<CData>* rst = nullptr;     // Optional, active high
+    };
+
+    struct Packet {
+        std::span<const T> data;
+        uint64_t time;                       // Time of the last beat
+    };
+
+    using BatchCallback = std::function<void(std::span<const Packet>)>;
+
+    struct Config {
+        size_t packet_beats = 1;             // Packet length when there is no tlast
+        size_t batch = 64;                   // Packets per delivery
+        size_t capacity = 64 * 1024;         // Buffered beats
+    };
+
+private:
+    Ports p_;
+    Config cfg_;
+    Scheduler& sched_;
+    BatchCallback deliver_;
+    std::vector<T> data_;
+    std::vector<Packet> done_;
+    size_t used_ = 0;                        // Beats in data_
+    size_t start_ = 0;                       // First beat of the open packet
+    uint64_t beats_ = 0;
+    uint64_t packets_ = 0;
+
+public:
+    AxiStreamSink(Scheduler& s, Observable* clk, Ports p, BatchCallback cb, Config cfg = {})
+        : p_(p), cfg_(cfg), sched_(s), deliver_(std::move(cb)), data_(cfg.capacity) {
+        done_.reserve(cfg_.batch);
+        p_.tready->write(1);
+        p_.tvalid->sample_eagerly();
+        p_.tdata->sample_eagerly();
+        if (p_.tlast) p_.tlast->sample_eagerly();
+        s.process({posedge(clk)}, [this](Scheduler&) { on_clock(); });
+    }
+
+    // Backpressure control for tests; takes effect after the next edge
+    void set_ready(bool r) { p_.tready->write(r); }
+
+    // Deliver completed packets now (e.g. at end of test)
+    void flush() {
+        if (done_.empty()) return;
+        deliver_(std::span<const Packet>(done_));
+        done_.clear();
+
+        // Move the open packet to the front of the buffer
+        size_t open = used_ - start_;
+        std::copy(data_.begin() + start_, data_.begin() + used_, data_.begin());
+        start_ = 0;
+        used_ = open;
+    }
+
+    uint64_t beats_received() const { return beats_; }
+    uint64_t packets_received() const { return packets_; }
+
+private:
+    void on_clock() {
+        if (p_.rst && p_.rst->val()) return;
+
+        if (!(p_.tvalid->before() && p_.tready->val())) return;
+
+        if (used_ == data_.size()) {
+            flush();
+            if (used_ == data_.size()) {
+                // Single packet larger than the buffer: split it
+                close_packet();
+                flush();
+            }
+        }
+
+        data_[used_++] = p_.tdata->before();
+        ++beats_;
+
+        bool last = p_.tlast ? bool(p_.tlast->before())
+                             : used_ - start_ == cfg_.packet_beats;
+        if (last) close_packet();
+        if (done_.size() == cfg_.batch) flush();
+    }
+
+    void close_packet() {
+        done_.push_back({std::span<const T>(data_.data() + start_, used_ - start_), sched_.time()});
+        start_ = used_;
+        ++packets_;
+    }
+};
+
+} // namespace Veroutines
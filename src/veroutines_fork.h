@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// fork_tests - Fork many tests from one in-memory checkpoint
+//
+// Run the shared prologue (reset, link training, ...) once, then call
+// fork_tests(): every child starts from the caller's exact state - models,
+// Scheduler, timed events and suspended coroutines - via copy-on-write,
+// runs test(i) and exits with its return value.
+//
+//   sched.run(ctx, top, tfp, prologue_end);
+//   auto codes = fork_tests(200, [&](size_t i) {
+//       seed(i);
+//       sched.run(ctx, top, tfp, prologue_end + test_len);
+//       return passed() ? 0 : 1;
+//   });
+//
+// Only the calling thread exists in a child. Fork before eval_threads()/
+// react_threads() or the first VR_* log message, or the child will wait on
+// workers that are not there. Children skip static destructors, so close
+// trace files inside test().
+// -----------------------------------------------------------------------------
+
+// Exit codes per test, in test order; 128 + signal for a crashed child,
+// -1 if it could not be forked or was reaped by someone else. Only the
+// children forked here are waited on; the caller's others are left alone.
+template<typename Test>
+std::vector<int> fork_tests(size_t n, Test&& test, size_t jobs = 0) {
+    if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<int> codes(n, -1);
+    std::unordered_map<pid_t, size_t> running;
+
+    auto wait_for = [](pid_t pid, int* status, int flags) {
+        pid_t r;
+        do r = ::waitpid(pid, status, flags); while (r < 0 && errno == EINTR);
+        return r;
+    };
+
+    // ECHILD: the child was reaped elsewhere (SIGCHLD ignored, another waiter)
+    auto settle = [&](auto it, pid_t pid, int status) {
+        if (pid < 0)
+            std::cerr << "[Veroutines] Lost the exit status of test " << it->second << "\n";
+        else if (WIFEXITED(status))
+            codes[it->second] = WEXITSTATUS(status);
+        else if (WIFSIGNALED(status))
+            codes[it->second] = 128 + WTERMSIG(status);
+        running.erase(it);
+    };
+
+    // Reap one of our children, blocking until one exits
+    auto reap = [&] {
+        for (;;) {
+            for (auto it = running.begin(); it != running.end(); ++it) {
+                int status = 0;
+                pid_t pid = wait_for(it->first, &status, WNOHANG);
+                if (pid != 0) return settle(it, pid, status);
+            }
+            // Sleep until any child has exited, leaving it unreaped. If it
+            // is not ours, block on one of ours rather than spin on it.
+            siginfo_t si{};
+            int r = ::waitid(P_ALL, 0, &si, WEXITED | WNOWAIT);
+            if (r < 0 && errno == EINTR) continue;
+            if (r == 0 && running.count(si.si_pid)) continue;
+            auto it = running.begin();
+            int status = 0;
+            pid_t pid = wait_for(it->first, &status, 0);
+            return settle(it, pid, status);
+        }
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        while (running.size() >= jobs) reap();
+
+        // Unflushed output would be written once per child
+        std::cout.flush();
+        std::fflush(nullptr);
+
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            int rc = test(i);
+            std::cout.flush();
+            std::fflush(nullptr);
+            ::_exit(rc);
+        }
+        if (pid < 0) {
+            std::cerr << "[Veroutines] fork failed for test " << i << "\n";
+            continue;
+        }
+        running.emplace(pid, i);
+    }
+    while (!running.empty()) reap();
+    return codes;
+}
+
+} // namespace Veroutines
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Build with -DVEROUTINES_LOG_LEVEL=<n> to compile out every message above
+// level n (0 error, 1 warn, 2 info, 3 debug, 4 trace). Defaults to info.
+#ifndef VEROUTINES_LOG_LEVEL
+#define VEROUTINES_LOG_LEVEL 2
+#endif
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// Asynchronous logger
+//
+// The calling thread only copies the sim time, the format string pointer and
+// the raw arguments into its own single-producer ring; a background thread
+// does the std::format and the I/O. Nothing allocates or locks per message.
+// -----------------------------------------------------------------------------
+
+enum class LogLevel : uint8_t { Error, Warn, Info, Debug, Trace };
+
+inline constexpr size_t kLogArgBytes = 64;
+
+// One binary message; args holds a std::tuple of the decayed arguments
+struct LogRecord {
+    using Formatter = void (*)(std::string& out, std::string_view fmt, const void* args);
+
+    uint64_t time;
+    Formatter format;
+    std::string_view fmt;
+    LogLevel level;
+    alignas(16) unsigned char args[kLogArgBytes];
+};
+
+// -----------------------------------------------------------------------------
+// LogRing - Bounded SPSC queue of records
+//
+// The producer claims and publishes one slot at a time; the consumer takes
+// everything available in one go and releases it after writing.
+// -----------------------------------------------------------------------------
+
+class LogRing {
+    std::unique_ptr<LogRecord[]> slots_;
+    uint64_t mask_;
+    alignas(64) std::atomic<uint64_t> head_{0};     // Next slot to publish
+    uint64_t cached_tail_ = 0;                      // Producer's view of tail_
+    alignas(64) std::atomic<uint64_t> tail_{0};     // Next slot to consume
+
+public:
+    explicit LogRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        slots_ = std::make_unique<LogRecord[]>(n);
+        mask_ = n - 1;
+    }
+
+    // Producer side
+    LogRecord* claim() {
+        uint64_t h = head_.load(std::memory_order_relaxed);
+        if (h - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (h - cached_tail_ > mask_) return nullptr;
+        }
+        return &slots_[h & mask_];
+    }
+
+    void publish() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint64_t published() const { return head_.load(std::memory_order_acquire); }
+
+    // Consumer side
+    uint64_t consumed() const { return tail_.load(std::memory_order_acquire); }
+
+    size_t available() const {
+        return published() - tail_.load(std::memory_order_relaxed);
+    }
+
+    const LogRecord& peek(size_t i) const {
+        return slots_[(tail_.load(std::memory_order_relaxed) + i) & mask_];
+    }
+
+    void release(size_t n) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Logger - Per-thread rings drained by one formatter thread
+//
+// Arguments are stored by value as raw bytes, so they must be trivially
+// copyable (numbers, enums, string_view/const char* to static text). Output
+// is ordered per producing thread.
+// -----------------------------------------------------------------------------
+
+class Logger {
+public:
+    enum class Overflow : uint8_t {
+        Block,      // Producer spins until the formatter frees a slot
+        Drop        // Message is discarded and counted in dropped()
+    };
+
+    struct Config {
+        FILE* out = stdout;
+        size_t capacity = 8192;                 // Records per thread
+        Overflow overflow = Overflow::Block;
+        LogLevel level = LogLevel::Trace;       // Runtime threshold
+    };
+
+private:
+    Config cfg_;
+    uint64_t id_;
+    std::atomic<LogLevel> level_;
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> stop_{false};
+
+    std::mutex rings_mutex_;                    // Taken on thread registration only
+    std::vector<std::unique_ptr<LogRing>> rings_;
+    std::thread worker_;
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id{0};
+        return ++id;
+    }
+
+public:
+    Logger() : Logger(Config{}) {}
+
+    explicit Logger(Config cfg)
+        : cfg_(cfg), id_(next_id()), level_(cfg.level) {
+        worker_ = std::thread([this] { drain_loop(); });
+    }
+
+    ~Logger() {
+        stop_.store(true, std::memory_order_release);
+        worker_.join();
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void set_level(LogLevel l) { level_.store(l, std::memory_order_relaxed); }
+    LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+    bool enabled(LogLevel l) const { return l <= level(); }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    template<typename... Args>
+    void write(uint64_t time, LogLevel l, std::format_string<Args...> fmt, Args&&... args) {
+        using Tuple = std::tuple<std::decay_t<Args>...>;
+        static_assert((std::is_trivially_copyable_v<std::decay_t<Args>> && ...),
+                      "log arguments are copied as raw bytes; pass values or static strings");
+        static_assert(sizeof(Tuple) <= kLogArgBytes && alignof(Tuple) <= 16,
+                      "log arguments do not fit in one record");
+
+        if (!enabled(l)) return;
+
+        LogRing& ring = local_ring();
+        LogRecord* r = ring.claim();
+        while (!r) {
+            if (cfg_.overflow == Overflow::Drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+            r = ring.claim();
+        }
+
+        r->time = time;
+        r->format = &format_record<Tuple>;
+        r->fmt = fmt.get();
+        r->level = l;
+        ::new (static_cast<void*>(r->args)) Tuple(std::forward<Args>(args)...);
+        ring.publish();
+    }
+
+    // Block until everything logged so far (by any thread) is written out
+    void flush() {
+        std::vector<std::pair<LogRing*, uint64_t>> marks;
+        {
+            std::lock_guard lock(rings_mutex_);
+            for (auto& r : rings_) marks.emplace_back(r.get(), r->published());
+        }
+        for (auto [ring, mark] : marks)
+            while (ring->consumed() < mark) std::this_thread::yield();
+    }
+
+private:
+    template<typename Tuple>
+    static void format_record(std::string& out, std::string_view fmt, const void* p) {
+        const auto& args = *std::launder(static_cast<const Tuple*>(p));
+        std::apply([&](const auto&... a) {
+            std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(a...));
+        }, args);
+    }
+
+    // Ring of the calling thread, registered on its first message
+    LogRing& local_ring() {
+        thread_local std::vector<std::pair<uint64_t, LogRing*>> owned;
+        if (!owned.empty() && owned.back().first == id_) return *owned.back().second;
+        for (auto& [id, ring] : owned)
+            if (id == id_) return *ring;
+
+        auto r = std::make_unique<LogRing>(cfg_.capacity);
+        owned.emplace_back(id_, r.get());
+        std::lock_guard lock(rings_mutex_);
+        rings_.push_back(std::move(r));
+        return *owned.back().second;
+    }
+
+    static void append_line(std::string& out, const LogRecord& r) {
+        static constexpr std::string_view tags[] = {"[ERROR] ", "[WARN] ", "", "[DEBUG] ", "[TRACE] "};
+        std::format_to(std::back_inserter(out), "@{:4d} {}", r.time, tags[size_t(r.level)]);
+        r.format(out, r.fmt, r.args);
+        out.push_back('\n');
+    }
+
+    void drain_loop() {
+        std::string text;
+        std::vector<LogRing*> rings;
+        std::vector<size_t> taken;
+
+        for (;;) {
+            // Read stop before draining so nothing published earlier is missed
+            bool stop = stop_.load(std::memory_order_acquire);
+            {
+                std::lock_guard lock(rings_mutex_);
+                rings.clear();
+                for (auto& r : rings_) rings.push_back(r.get());
+            }
+
+            taken.assign(rings.size(), 0);
+            for (size_t i = 0; i < rings.size(); ++i) {
+                size_t n = rings[i]->available();
+                for (size_t k = 0; k < n; ++k) append_line(text, rings[i]->peek(k));
+                taken[i] = n;
+            }
+
+            if (!text.empty()) {
+                std::fwrite(text.data(), 1, text.size(), cfg_.out);
+                std::fflush(cfg_.out);
+                text.clear();
+                // Release only once written, so flush() implies visible output
+                for (size_t i = 0; i < rings.size(); ++i) rings[i]->release(taken[i]);
+                continue;
+            }
+
+            if (stop) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+};
+
+// Process-wide logger used by the VR_* macros
+inline Logger& default_logger() {
+    static Logger logger;
+    return logger;
+}
+
+} // namespace Veroutines
+
+// -----------------------------------------------------------------------------
+// Logging macros
+//
+// Levels above VEROUTINES_LOG_LEVEL are discarded at compile time, including
+// argument evaluation. VR_LOG takes an explicit time; the others take anything
+// with time() (usually the Scheduler).
+// -----------------------------------------------------------------------------
+
+#define VR_LOG(lvl, t, ...)                                                             \
+    do {                                                                                \
+        if constexpr (int(::Veroutines::LogLevel::lvl) <= VEROUTINES_LOG_LEVEL)          \
+            ::Veroutines::default_logger().write((t), ::Veroutines::LogLevel::lvl, __VA_ARGS__); \
+    } while (0)
+
+#define VR_ERROR(sched, ...) VR_LOG(Error, (sched).time(), __VA_ARGS__)
+#define VR_WARN(sched, ...)  VR_LOG(Warn,  (sched).time(), __VA_ARGS__)
+#define VR_INFO(sched, ...)  VR_LOG(Info,  (sched).time(), __VA_ARGS__)
+#define VR_DEBUG(sched, ...) VR_LOG(Debug, (sched).time(), __VA_ARGS__)
+#define VR_TRACE(sched, ...) VR_LOG(Trace, (sched).time(), __VA_ARGS__)
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <verilated.h>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// run_seeds - Many seeds of one bench on a thread pool, in one process
+//
+// Each seed gets its own VerilatedContext (seeded with randSeed() before
+// the model is built, so randReset applies per seed; see
+// verilator_seed()), TopModel and
+// Scheduler, constructed on the worker that runs it. The bench callable
+// registers ports, runs the scheduler and returns pass/fail; everything
+// it captures by reference is shared by all workers, so stimulus and
+// expected data must be read-only.
+//
+//   const auto stimulus = make_stimulus();
+//   auto summary = run_seeds<Vaxibox>(seeds, [&](SeedRun<Vaxibox>& r) {
+//       auto clk = r.sched.input(&r.top.clk);
+//       ...
+//       r.sched.run(&r.ctx, &r.top);
+//       return received == stimulus;
+//   });
+//   summary.print(std::cout);
+//
+// Verilator allows one context per thread; a design built with --threads
+// also starts its own workers, so size jobs accordingly. $fatal and
+// Verilated errors still end the whole process.
+// -----------------------------------------------------------------------------
+
+// randSeed() takes an int. Seeds up to INT32_MAX are passed unchanged, so
+// a seed reproduces in a standalone run; wider seeds are folded with the
+// splitmix64 finalizer into [1, INT32_MAX] instead of being truncated.
+// SeedRun::seed keeps the full 64 bits for the bench's own generators.
+inline int verilator_seed(uint64_t seed) {
+    if (seed <= uint64_t(INT32_MAX)) return int(seed);
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ull;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebull;
+    seed ^= seed >> 31;
+    return int(seed & INT32_MAX) | 1;
+}
+
+template<typename TopModel>
+struct SeedRun {
+    uint64_t seed;
+    size_t index;             // Position in the seed list
+    VerilatedContext& ctx;
+    TopModel& top;
+    Scheduler& sched;
+    std::string note;         // Optional detail shown for a failed seed
+};
+
+struct SeedResult {
+    uint64_t seed;
+    bool passed;
+    uint64_t sim_time;
+    uint64_t timesteps;
+    uint64_t deltas;
+    double seconds;
+    std::string note;
+};
+
+struct RegressionSummary {
+    std::vector<SeedResult> results;    // In seed-list order
+    size_t passed = 0;
+    size_t failed = 0;
+    double wall_seconds = 0;            // Whole regression
+    double cpu_seconds = 0;             // Summed over seeds
+    uint64_t timesteps = 0;
+    uint64_t deltas = 0;
+
+    bool ok() const { return failed == 0; }
+
+    void print(std::ostream& os) const {
+        os << "[Veroutines] Regression: " << passed << " passed, " << failed << " failed, "
+           << results.size() << " seeds\n";
+        for (const auto& r : results)
+            if (!r.passed) {
+                os << "[Veroutines]   FAIL seed " << r.seed << " at t=" << r.sim_time;
+                if (!r.note.empty()) os << ": " << r.note;
+                os << "\n";
+            }
+        os << "[Veroutines]   " << std::fixed << std::setprecision(2) << wall_seconds * 1e3
+           << " ms wall, " << cpu_seconds * 1e3 << " ms in seeds, " << timesteps
+           << " timesteps, " << deltas << " deltas";
+        if (wall_seconds > 0)
+            os << " (" << std::scientific << std::setprecision(3)
+               << double(timesteps) / wall_seconds << " steps/s)";
+        os << std::defaultfloat << "\n";
+    }
+};
+
+struct RegressOptions {
+    size_t jobs = 0;            // Worker threads; 0 = hardware concurrency
+    int rand_reset = 2;         // VerilatedContext::randReset() for every seed
+};
+
+template<typename TopModel, typename Bench>
+RegressionSummary run_seeds(std::span<const uint64_t> seeds, Bench&& bench,
+                            const RegressOptions& opt = {}) {
+    size_t jobs = opt.jobs ? opt.jobs : std::max(1u, std::thread::hardware_concurrency());
+    jobs = std::min(jobs, std::max<size_t>(seeds.size(), 1));
+
+    RegressionSummary summary;
+    summary.results.resize(seeds.size());
+    std::atomic<size_t> next{0};
+
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < seeds.size();) {
+            SeedResult& res = summary.results[i];
+            res.seed = seeds[i];
+            auto t0 = std::chrono::steady_clock::now();
+
+            auto ctx = std::make_unique<VerilatedContext>();
+            ctx->randSeed(verilator_seed(seeds[i]));
+            ctx->randReset(opt.rand_reset);
+            auto top = std::make_unique<TopModel>(ctx.get(), "");
+            Scheduler sched;
+
+            SeedRun<TopModel> run{seeds[i], i, *ctx, *top, sched, {}};
+            try {
+                res.passed = bench(run);
+            } catch (const std::exception& e) {
+                res.passed = false;
+                run.note = e.what();
+            }
+            top->final();
+
+            res.sim_time = sched.time();
+            res.timesteps = sched.timesteps();
+            res.deltas = sched.deltas();
+            res.note = std::move(run.note);
+            res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < jobs; ++w) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+    summary.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (const auto& r : summary.results) {
+        (r.passed ? summary.passed : summary.failed) += 1;
+        summary.cpu_seconds += r.seconds;
+        summary.timesteps += r.timesteps;
+        summary.deltas += r.deltas;
+    }
+    return summary;
+}
+
+// Seeds first, first + 1, ..., first + count - 1
+template<typename TopModel, typename Bench>
+RegressionSummary run_seeds(uint64_t first, size_t count, Bench&& bench,
+                            const RegressOptions& opt = {}) {
+    std::vector<uint64_t> seeds(count);
+    for (size_t i = 0; i < count; ++i) seeds[i] = first + i;
+    return run_seeds<TopModel>(std::span<const uint64_t>(seeds), std::forward<Bench>(bench), opt);
+}
+
+} // namespace Veroutines
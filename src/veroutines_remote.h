@@ -0,0 +1,721 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// Distributed co-simulation
+//
+// Each partition is one Scheduler (own process, thread or node). A
+// RemoteLink joins two partitions over a Channel: values committed on one
+// side arrive on the other `latency` ticks later, as timed events. That
+// latency is the lookahead of a conservative (null message) protocol run
+// by Partition through the scheduler's time gate:
+//
+//   - a partition promises each peer that no message will deliver before
+//     min(next local timestep, earliest possible remote delivery) + latency
+//   - it may run every timestep below the smallest promise it holds
+//
+// so partitions run in parallel while their windows do not overlap, and
+// block only when one catches up with another. Latency must be >= 1.
+//
+//   Partition part(sched);
+//   auto& link = part.link(TcpChannel::connect("soc-b", 7000), 5);
+//   link.publish(0, axi_awvalid);                    // Local observable -> peer
+//   auto* bready = link.subscribe<CData>(1);         // Peer value, read-only here
+//   link.subscribe(2, rdata_in);                     // Peer value -> DUT input
+//   sched.run(ctx, top, tfp, end);
+//   part.close();
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// Channel - Non-blocking byte stream between two partitions
+// -----------------------------------------------------------------------------
+
+class Channel {
+public:
+    virtual ~Channel() = default;
+    virtual size_t write_some(const void* p, size_t n) = 0;   // Bytes accepted
+    virtual size_t read_some(void* p, size_t n) = 0;          // Bytes read
+    virtual bool ok() const { return true; }                  // False once broken
+};
+
+// -----------------------------------------------------------------------------
+// ShmChannel - Two SPSC byte rings in shared memory
+//
+// pair() maps an anonymous region for partitions that are threads of one
+// process or children forked after it. The named constructor uses POSIX
+// shared memory: side 0 creates (and later unlinks) it, side 1 opens it.
+// Both sides pass the same nonzero run id; side 0 stamps it into the
+// rings once they are set up, and side 1 only attaches to a segment
+// carrying it, so a segment left behind by a crashed run is never used.
+// -----------------------------------------------------------------------------
+
+class ShmChannel : public Channel {
+    struct Ring {
+        alignas(64) std::atomic<uint64_t> head;     // Bytes written
+        alignas(64) std::atomic<uint64_t> tail;     // Bytes read
+        alignas(64) uint64_t size;
+        std::atomic<uint64_t> run;                  // Set last by the creator; 0 until then
+    };
+
+    struct Region {
+        void* base = nullptr;
+        size_t bytes = 0;
+        std::string name;                            // Unlinked on release if set
+        ~Region() {
+            if (base) ::munmap(base, bytes);
+            if (!name.empty()) ::shm_unlink(name.c_str());
+        }
+    };
+
+    std::shared_ptr<Region> region_;
+    Ring* tx_ = nullptr;
+    Ring* rx_ = nullptr;
+
+    static constexpr size_t kHeader = 256;           // Ring header, padded
+
+    static size_t layout(size_t ring) { return 2 * (kHeader + ring); }
+    static Ring* ring(void* base, size_t ring, int i) {
+        return reinterpret_cast<Ring*>(static_cast<unsigned char*>(base) + i * (kHeader + ring));
+    }
+    static unsigned char* data(Ring* r) { return reinterpret_cast<unsigned char*>(r) + kHeader; }
+
+    static size_t round_up(size_t bytes) {
+        size_t n = 4096;
+        while (n < bytes) n <<= 1;
+        return n;
+    }
+
+    static void init(void* base, size_t size, uint64_t run) {
+        for (int i = 0; i < 2; ++i) {
+            Ring* r = ::new (ring(base, size, i)) Ring{};
+            r->size = size;
+            r->run.store(run, std::memory_order_release);
+        }
+    }
+
+    static bool stamped(void* base, size_t size, uint64_t run) {
+        for (int i = 0; i < 2; ++i)
+            if (ring(base, size, i)->run.load(std::memory_order_acquire) != run) return false;
+        return true;
+    }
+
+    ShmChannel(std::shared_ptr<Region> region, int side) : region_(std::move(region)) {
+        size_t size = ring(region_->base, 0, 0)->size;
+        tx_ = ring(region_->base, size, side);
+        rx_ = ring(region_->base, size, 1 - side);
+    }
+
+public:
+    // Both ends of one anonymous channel with rings of at least `bytes`
+    static std::pair<std::unique_ptr<ShmChannel>, std::unique_ptr<ShmChannel>>
+    pair(size_t bytes = 4 << 20) {
+        size_t size = round_up(bytes);
+        auto region = std::make_shared<Region>();
+        void* p = ::mmap(nullptr, layout(size), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "[Veroutines] Cannot map shared channel\n";
+            return {};
+        }
+        region->base = p;
+        region->bytes = layout(size);
+        init(p, size, 1);
+        return {std::unique_ptr<ShmChannel>(new ShmChannel(region, 0)),
+                std::unique_ptr<ShmChannel>(new ShmChannel(region, 1))};
+    }
+
+    // Named channel (e.g. "/soc-a-b"); side 1 waits up to `wait_ms` for
+    // side 0 to create it for the same run
+    static std::unique_ptr<ShmChannel> open(const char* name, int side, uint64_t run,
+                                            size_t bytes = 4 << 20, int wait_ms = 10000) {
+        if (run == 0) {
+            std::cerr << "[Veroutines] Shared channel " << name << " needs a nonzero run id\n";
+            return nullptr;
+        }
+        size_t size = round_up(bytes);
+        void* p = nullptr;
+        if (side == 0) {
+            // Never reuse a segment of an earlier run, whoever still maps it
+            ::shm_unlink(name);
+            int fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd >= 0 && ::ftruncate(fd, off_t(layout(size))) != 0) {
+                ::close(fd);
+                ::shm_unlink(name);
+                fd = -1;
+            }
+            if (fd < 0) {
+                std::cerr << "[Veroutines] Cannot create shared channel " << name << "\n";
+                return nullptr;
+            }
+            p = ::mmap(nullptr, layout(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) {
+                ::shm_unlink(name);
+                std::cerr << "[Veroutines] Cannot map shared channel " << name << "\n";
+                return nullptr;
+            }
+            init(p, size, run);
+        } else {
+            // Retry until the name holds a segment side 0 stamped with this run
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+            for (;; std::this_thread::sleep_for(std::chrono::milliseconds(1))) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    std::cerr << "[Veroutines] No shared channel " << name << " for run " << run << "\n";
+                    return nullptr;
+                }
+                int fd = ::shm_open(name, O_RDWR, 0600);
+                if (fd < 0) continue;
+                struct stat st{};
+                if (::fstat(fd, &st) != 0 || size_t(st.st_size) < 2 * kHeader) {
+                    ::close(fd);
+                    continue;
+                }
+                size = size_t(st.st_size) / 2 - kHeader;
+                p = ::mmap(nullptr, layout(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (p == MAP_FAILED) {
+                    std::cerr << "[Veroutines] Cannot map shared channel " << name << "\n";
+                    return nullptr;
+                }
+                if (stamped(p, size, run)) break;
+                ::munmap(p, layout(size));
+            }
+        }
+        auto region = std::make_shared<Region>();
+        region->base = p;
+        region->bytes = layout(size);
+        if (side == 0) region->name = name;
+        return std::unique_ptr<ShmChannel>(new ShmChannel(region, side));
+    }
+
+    size_t write_some(const void* p, size_t n) override {
+        const uint64_t head = tx_->head.load(std::memory_order_relaxed);
+        const uint64_t tail = tx_->tail.load(std::memory_order_acquire);
+        const uint64_t size = tx_->size;
+        n = std::min<size_t>(n, size - (head - tail));
+        copy_in(data(tx_), size, head, static_cast<const unsigned char*>(p), n);
+        tx_->head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t read_some(void* p, size_t n) override {
+        const uint64_t tail = rx_->tail.load(std::memory_order_relaxed);
+        const uint64_t head = rx_->head.load(std::memory_order_acquire);
+        const uint64_t size = rx_->size;
+        n = std::min<size_t>(n, head - tail);
+        copy_out(static_cast<unsigned char*>(p), data(rx_), size, tail, n);
+        rx_->tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    static void copy_in(unsigned char* ring, uint64_t size, uint64_t at, const unsigned char* p, size_t n) {
+        size_t off = size_t(at & (size - 1));
+        size_t first = std::min<size_t>(n, size - off);
+        std::memcpy(ring + off, p, first);
+        std::memcpy(ring, p + first, n - first);
+    }
+
+    static void copy_out(unsigned char* p, const unsigned char* ring, uint64_t size, uint64_t at, size_t n) {
+        size_t off = size_t(at & (size - 1));
+        size_t first = std::min<size_t>(n, size - off);
+        std::memcpy(p, ring + off, first);
+        std::memcpy(p + first, ring, n - first);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// TcpChannel - Non-blocking TCP stream (TCP_NODELAY)
+// -----------------------------------------------------------------------------
+
+class TcpChannel : public Channel {
+    int fd_ = -1;
+    bool ok_ = true;
+
+    explicit TcpChannel(int fd) : fd_(fd) {
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+    }
+
+public:
+    ~TcpChannel() override {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    // Accept one peer on `port`
+    static std::unique_ptr<TcpChannel> listen(uint16_t port) {
+        int ls = ::socket(AF_INET6, SOCK_STREAM, 0);
+        if (ls < 0) {
+            std::cerr << "[Veroutines] Cannot create socket\n";
+            return nullptr;
+        }
+        int one = 1, zero = 0;
+        ::setsockopt(ls, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(ls, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+        sockaddr_in6 addr{};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = htons(port);
+        if (::bind(ls, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(ls, 1) != 0) {
+            std::cerr << "[Veroutines] Cannot listen on port " << port << "\n";
+            ::close(ls);
+            return nullptr;
+        }
+        int fd = ::accept(ls, nullptr, nullptr);
+        ::close(ls);
+        if (fd < 0) {
+            std::cerr << "[Veroutines] Accept failed on port " << port << "\n";
+            return nullptr;
+        }
+        return std::unique_ptr<TcpChannel>(new TcpChannel(fd));
+    }
+
+    // Connect to a listening peer, retrying for up to `wait_ms`
+    static std::unique_ptr<TcpChannel> connect(const char* host, uint16_t port, int wait_ms = 10000) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        const std::string service = std::to_string(port);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+        do {
+            addrinfo* res = nullptr;
+            if (::getaddrinfo(host, service.c_str(), &hints, &res) == 0) {
+                for (addrinfo* a = res; a; a = a->ai_next) {
+                    int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                    if (fd < 0) continue;
+                    if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+                        ::freeaddrinfo(res);
+                        return std::unique_ptr<TcpChannel>(new TcpChannel(fd));
+                    }
+                    ::close(fd);
+                }
+                ::freeaddrinfo(res);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        } while (std::chrono::steady_clock::now() < deadline);
+        std::cerr << "[Veroutines] Cannot connect to " << host << ":" << port << "\n";
+        return nullptr;
+    }
+
+    size_t write_some(const void* p, size_t n) override {
+        if (!ok_ || n == 0) return 0;
+        ssize_t w = ::send(fd_, p, n, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) ok_ = false;
+            return 0;
+        }
+        return size_t(w);
+    }
+
+    size_t read_some(void* p, size_t n) override {
+        if (!ok_ || n == 0) return 0;
+        ssize_t r = ::recv(fd_, p, n, 0);
+        if (r == 0) ok_ = false;
+        if (r < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) ok_ = false;
+            return 0;
+        }
+        return size_t(r);
+    }
+
+    bool ok() const override { return ok_; }
+};
+
+// -----------------------------------------------------------------------------
+// RemotePort<T> - A peer partition's value, read-only on this side
+//
+// A Signal driven by its RemoteLink: updates are committed like any
+// signal write, so processes and coroutines wait on it as usual.
+// -----------------------------------------------------------------------------
+
+class RemoteLink;
+
+template<typename T>
+class RemotePort : public Signal<T> {
+    friend class RemoteLink;
+    using Signal<T>::write;
+    using Signal<T>::operator=;
+
+public:
+    using Signal<T>::Signal;
+};
+
+// -----------------------------------------------------------------------------
+// RemoteLink - Values exchanged with one peer partition
+//
+// Published observables are captured at REACT by one process each; the
+// last value per timestep goes out in that timestep's batch, one message
+// per timestep with changes. Received batches become one timed event each,
+// at the sender's timestep + latency. Ids are chosen by the user and must
+// agree on both sides, as must the value types. Message layout:
+//
+//   RemoteHeader | (RemoteRecord value-padded-to-8)*records
+// -----------------------------------------------------------------------------
+
+inline constexpr size_t pad8(size_t n) { return (n + 7) & ~size_t(7); }
+
+struct RemoteHeader {
+    uint32_t bytes;            // Whole message
+    uint32_t records;
+    uint64_t deliver;          // Time to apply the records
+    uint64_t promise;          // No later message delivers before this
+};
+
+struct RemoteRecord {
+    uint32_t id;
+    uint32_t bytes;            // Value size before padding
+};
+
+class RemoteLink {
+    friend class Partition;
+
+    struct Published {
+        const Observable* obs;
+        uint32_t id;
+        uint32_t bytes;
+        void (*get)(const Observable*, void*);
+        size_t at;             // Offset of its record in the open batch, or SIZE_MAX
+    };
+
+    struct Subscribed {
+        Observable* obs = nullptr;
+        uint32_t bytes = 0;
+        void (*put)(Observable*, const void*) = nullptr;
+    };
+
+    Scheduler& sched_;
+    std::unique_ptr<Channel> ch_;
+    uint64_t latency_;
+
+    std::vector<Published> published_;
+    std::vector<Subscribed> subscribed_;           // By id
+
+    std::mutex mutex_;                             // Captures may run on REACT workers
+    std::vector<unsigned char> batch_;             // Open batch, header first
+    uint64_t batch_time_ = UINT64_MAX;
+    uint32_t batch_records_ = 0;
+    std::vector<uint32_t> touched_;                // Published entries with a record in batch_
+
+    std::vector<unsigned char> tx_;                // Sealed messages not yet accepted by ch_
+    size_t tx_off_ = 0;
+    std::vector<unsigned char> rx_;
+    std::deque<std::vector<unsigned char>> inbox_; // Received batches awaiting delivery
+
+    uint64_t peer_promise_ = 0;
+    uint64_t sent_promise_ = 0;
+    uint64_t sent_ = 0;
+    uint64_t received_ = 0;
+
+public:
+    RemoteLink(Scheduler& s, std::unique_ptr<Channel> ch, uint64_t latency)
+        : sched_(s), ch_(std::move(ch)), latency_(std::max<uint64_t>(latency, 1)) {}
+
+    RemoteLink(const RemoteLink&) = delete;
+    RemoteLink& operator=(const RemoteLink&) = delete;
+
+    // Send every change of a local port or signal (and its current value)
+    template<typename P>
+    void publish(uint32_t id, P* obs) {
+        using T = std::decay_t<decltype(obs->val())>;
+        uint32_t i = uint32_t(published_.size());
+        published_.push_back({obs, id, uint32_t(sizeof(T)),
+                              [](const Observable* o, void* out) {
+                                  ValueRef<T> v = static_cast<const P*>(o)->val();
+                                  std::memcpy(out, &v, sizeof(T));
+                              },
+                              SIZE_MAX});
+        sched_.process({obs}, [this, i](Scheduler& s) { capture(i, s.time()); });
+        capture(i, sched_.time());
+    }
+
+    // The peer's value `id` as a local signal
+    template<typename T>
+    RemotePort<T>* subscribe(uint32_t id, T initial = T{}) {
+        auto* port = sched_.signal_of<RemotePort<T>>(initial);
+        bind(id, port, sizeof(T), [](Observable* o, const void* in) {
+            T v;
+            std::memcpy(&v, in, sizeof(T));
+            static_cast<RemotePort<T>*>(o)->write(v);
+        });
+        return port;
+    }
+
+    // The peer's value `id` driven straight onto a DUT input
+    template<typename T>
+    void subscribe(uint32_t id, InputPort<T>* port) {
+        bind(id, port, sizeof(T), [](Observable* o, const void* in) {
+            T v;
+            std::memcpy(&v, in, sizeof(T));
+            static_cast<InputPort<T>*>(o)->write(v);
+        });
+    }
+
+    uint64_t latency() const { return latency_; }
+    uint64_t messages_sent() const { return sent_; }
+    uint64_t messages_received() const { return received_; }
+    bool ok() const { return ch_ && ch_->ok(); }
+
+private:
+    void bind(uint32_t id, Observable* obs, size_t bytes, void (*put)(Observable*, const void*)) {
+        if (id >= subscribed_.size()) subscribed_.resize(id + 1);
+        subscribed_[id] = {obs, uint32_t(bytes), put};
+    }
+
+    void capture(uint32_t i, uint64_t now) {
+        std::lock_guard lock(mutex_);
+        Published& p = published_[i];
+        if (batch_time_ != now) {
+            seal();
+            batch_time_ = now;
+        }
+        if (p.at == SIZE_MAX) {
+            if (batch_.empty()) batch_.resize(sizeof(RemoteHeader));
+            RemoteRecord r{p.id, p.bytes};
+            p.at = batch_.size();
+            batch_.resize(p.at + sizeof(r) + pad8(p.bytes));
+            std::memcpy(batch_.data() + p.at, &r, sizeof(r));
+            touched_.push_back(i);
+            ++batch_records_;
+        }
+        p.get(p.obs, batch_.data() + p.at + sizeof(RemoteRecord));
+    }
+
+    // Close the open batch into tx_ (caller holds mutex_ or is the gate)
+    void seal() {
+        if (!batch_records_) return;
+        RemoteHeader h{uint32_t(batch_.size()), batch_records_, batch_time_ + latency_,
+                       batch_time_ + latency_};
+        std::memcpy(batch_.data(), &h, sizeof(h));
+        tx_.insert(tx_.end(), batch_.begin(), batch_.end());
+        sent_promise_ = std::max(sent_promise_, h.promise);
+        ++sent_;
+        batch_.clear();
+        batch_records_ = 0;
+        for (uint32_t i : touched_) published_[i].at = SIZE_MAX;
+        touched_.clear();
+    }
+
+    // Null message; only if the promise moved by `latency` (or `force`)
+    void promise(uint64_t p, bool force) {
+        if (p <= sent_promise_ || (!force && p - sent_promise_ < latency_)) return;
+        RemoteHeader h{uint32_t(sizeof(RemoteHeader)), 0, UINT64_MAX, p};
+        const auto* b = reinterpret_cast<const unsigned char*>(&h);
+        tx_.insert(tx_.end(), b, b + sizeof(h));
+        sent_promise_ = p;
+        ++sent_;
+    }
+
+    void pump_out() {
+        while (tx_off_ < tx_.size()) {
+            size_t n = ch_->write_some(tx_.data() + tx_off_, tx_.size() - tx_off_);
+            if (n == 0) break;
+            tx_off_ += n;
+        }
+        if (tx_off_ == tx_.size()) {
+            tx_.clear();
+            tx_off_ = 0;
+        }
+    }
+
+    // Read what has arrived; true if anything did
+    bool pump_in() {
+        bool any = false;
+        unsigned char buf[16384];
+        for (size_t n; (n = ch_->read_some(buf, sizeof(buf))) > 0;) {
+            rx_.insert(rx_.end(), buf, buf + n);
+            any = true;
+        }
+        size_t off = 0;
+        while (rx_.size() - off >= sizeof(RemoteHeader)) {
+            RemoteHeader h;
+            std::memcpy(&h, rx_.data() + off, sizeof(h));
+            if (h.bytes < sizeof(h)) {
+                std::cerr << "[Veroutines] Corrupt message from peer partition\n";
+                rx_.clear();
+                ch_.reset(new Broken);
+                return any;
+            }
+            if (rx_.size() - off < h.bytes) break;
+            if (h.records) deliver(h, rx_.data() + off + sizeof(h), h.bytes - sizeof(h));
+            peer_promise_ = std::max(peer_promise_, h.promise);
+            ++received_;
+            off += h.bytes;
+        }
+        rx_.erase(rx_.begin(), rx_.begin() + ptrdiff_t(off));
+        return any;
+    }
+
+    void deliver(const RemoteHeader& h, const unsigned char* body, size_t bytes) {
+        uint64_t t = h.deliver;
+        if (t < sched_.time()) {
+            std::cerr << "[Veroutines] Remote batch for t=" << t << " arrived at t="
+                      << sched_.time() << "\n";
+            t = sched_.time();
+        }
+        inbox_.emplace_back(body, body + bytes);
+        sched_.schedule_at(t, [this] { apply(); });
+    }
+
+    // Oldest received batch; events fire in arrival order
+    void apply() {
+        const auto& b = inbox_.front();
+        for (size_t off = 0; off + sizeof(RemoteRecord) <= b.size();) {
+            RemoteRecord r;
+            std::memcpy(&r, b.data() + off, sizeof(r));
+            off += sizeof(r);
+            if (r.id < subscribed_.size() && subscribed_[r.id].obs) {
+                const Subscribed& s = subscribed_[r.id];
+                if (s.bytes == r.bytes) s.put(s.obs, b.data() + off);
+                else std::cerr << "[Veroutines] Remote value " << r.id << " is " << r.bytes
+                               << " bytes, subscribed as " << s.bytes << "\n";
+            }
+            off += pad8(r.bytes);
+        }
+        inbox_.pop_front();
+    }
+
+    struct Broken : Channel {
+        size_t write_some(const void*, size_t) override { return 0; }
+        size_t read_some(void*, size_t) override { return 0; }
+        bool ok() const override { return false; }
+    };
+};
+
+// -----------------------------------------------------------------------------
+// Partition - Conservative synchronization of one Scheduler with its peers
+//
+// Installs the scheduler's time gate. Before each timestep the gate seals
+// the last timestep's batches, reads whatever has arrived and lets the
+// timestep run if it starts before every peer's promise; otherwise it
+// sends its own promise and waits. A broken channel or a peer that
+// closed counts as a promise of "never".
+// -----------------------------------------------------------------------------
+
+class Partition {
+    Scheduler& sched_;
+    std::vector<std::unique_ptr<RemoteLink>> links_;
+    uint64_t waits_ = 0;
+    double wait_seconds_ = 0;
+    bool closed_ = false;
+
+public:
+    explicit Partition(Scheduler& s) : sched_(s) {
+        s.time_gate([this](Scheduler&) { return gate(); });
+    }
+
+    ~Partition() {
+        close();
+        sched_.time_gate(nullptr);
+    }
+
+    Partition(const Partition&) = delete;
+    Partition& operator=(const Partition&) = delete;
+
+    // Join a peer; latency (>= 1) is both the transport delay and the lookahead
+    RemoteLink& link(std::unique_ptr<Channel> ch, uint64_t latency) {
+        if (!ch) {
+            std::cerr << "[Veroutines] Partition link without a channel\n";
+            ch.reset(new RemoteLink::Broken);
+        }
+        links_.push_back(std::make_unique<RemoteLink>(sched_, std::move(ch), latency));
+        return *links_.back();
+    }
+
+    // Promise peers nothing more; call once this partition's run is over
+    void close() {
+        if (closed_) return;
+        closed_ = true;
+        for (auto& l : links_) {
+            std::lock_guard lock(l->mutex_);
+            l->seal();
+            l->promise(UINT64_MAX, true);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        for (;;) {
+            bool pending = false;
+            for (auto& l : links_) {
+                l->pump_out();
+                pending |= l->ok() && !l->tx_.empty();
+            }
+            if (!pending) break;
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::cerr << "[Veroutines] Partition closed with unsent messages\n";
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // Gate calls that had to wait for a peer, and the time spent waiting
+    uint64_t waits() const { return waits_; }
+    double wait_seconds() const { return wait_seconds_; }
+
+private:
+    uint64_t peer_horizon() const {
+        uint64_t h = UINT64_MAX;
+        for (auto& l : links_)
+            if (l->ok()) h = std::min(h, l->peer_promise_);
+        return h;
+    }
+
+    uint64_t gate() {
+        for (auto& l : links_) {
+            std::lock_guard lock(l->mutex_);
+            l->seal();
+        }
+
+        std::chrono::steady_clock::time_point t0{};
+        for (size_t spin = 0;; ++spin) {
+            for (auto& l : links_) l->pump_in();
+
+            const uint64_t next = sched_.next_time();
+            const uint64_t in = peer_horizon();
+            const bool go = next < in || in == UINT64_MAX;
+
+            const uint64_t earliest = std::min(next, in);
+            for (auto& l : links_) {
+                uint64_t p = earliest == UINT64_MAX ? UINT64_MAX : earliest + l->latency_;
+                l->promise(p, !go);
+                l->pump_out();
+            }
+
+            if (go) {
+                if (spin) wait_seconds_ += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - t0).count();
+                return in;
+            }
+            if (spin == 0) {
+                ++waits_;
+                t0 = std::chrono::steady_clock::now();
+            }
+            if (spin < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+};
+
+} // namespace Veroutines
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// Binary stimulus traces
+//
+// A trace is a header, one byte width per port, then (time, delta, port,
+// value) records in time order. `delta` numbers the deltas of one
+// timestep that changed a recorded port, so a zero-time pulse is two
+// records with the same time. Values are the raw port type, padded to
+// 8 bytes, so replay is a memcpy per record:
+//
+//   TraceHeader | uint32_t bytes[ports] (padded to 8) | TraceRecord value ...
+//
+// Port ids are positions in the port list given to the recorder; replay
+// takes ports of the same types in the same order.
+// -----------------------------------------------------------------------------
+
+struct TraceHeader {
+    char magic[8];            // "VRTRACE2"
+    uint32_t ports;
+    uint32_t reserved;
+};
+
+struct TraceRecord {
+    uint64_t time;
+    uint32_t delta;           // Changing delta within the timestep, from 0
+    uint32_t port;
+    uint32_t bytes;           // Value size before padding
+    uint32_t reserved;
+};
+
+inline constexpr char kTraceMagic[8] = {'V', 'R', 'T', 'R', 'A', 'C', 'E', '2'};
+
+inline constexpr size_t trace_pad(size_t n) { return (n + 7) & ~size_t(7); }
+
+namespace detail {
+
+// Type-erased access to one InputPort<T>
+struct TracePort {
+    Observable* port;
+    uint32_t bytes;
+    void (*get)(Observable*, void*);
+    void (*put)(Observable*, const void*);
+};
+
+template<typename T>
+TracePort trace_port(InputPort<T>* p) {
+    return {p, uint32_t(sizeof(T)),
+            [](Observable* o, void* out) {
+                ValueRef<T> v = static_cast<InputPort<T>*>(o)->val();
+                std::memcpy(out, &v, sizeof(T));
+            },
+            [](Observable* o, const void* in) {
+                T v;
+                std::memcpy(&v, in, sizeof(T));
+                static_cast<InputPort<T>*>(o)->write(v);
+            }};
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// TraceRecorder - Capture input port commits
+//
+// One process sensitive to every recorded port appends a record for each
+// port whose committed value changed, so every delta that changed an
+// input is captured, numbered in order within its timestep. The values
+// at construction are recorded first, at the current time. Records are buffered and written in large blocks.
+//
+//   TraceRecorder rec(sched, "run.vrt", valid, data, last);
+//   TraceReplay   rp (sched, "run.vrt", valid, data, last);   // later run
+// -----------------------------------------------------------------------------
+
+class TraceRecorder {
+    Scheduler& sched_;
+    FILE* out_ = nullptr;
+    std::vector<detail::TracePort> ports_;
+    std::vector<unsigned char> buf_;
+    uint64_t records_ = 0;
+    uint64_t time_ = 0;         // Timestep of the last recorded delta
+    uint32_t delta_ = 0;
+
+    static constexpr size_t kFlushBytes = 1 << 20;
+
+public:
+    template<typename... Ts>
+    TraceRecorder(Scheduler& s, const char* path, InputPort<Ts>*... ports)
+        : sched_(s), ports_{detail::trace_port(ports)...} {
+        out_ = std::fopen(path, "wb");
+        if (!out_) {
+            std::cerr << "[Veroutines] Cannot open trace " << path << " for writing\n";
+            return;
+        }
+        TraceHeader h{};
+        std::memcpy(h.magic, kTraceMagic, sizeof(h.magic));
+        h.ports = uint32_t(ports_.size());
+        append(&h, sizeof(h));
+        for (const auto& p : ports_) append(&p.bytes, sizeof(p.bytes));
+        buf_.resize(trace_pad(buf_.size()));
+
+        time_ = s.time();
+        for (uint32_t i = 0; i < ports_.size(); ++i) record(i);
+        s.process({Sensitivity(ports)...}, [this](Scheduler& s) {
+            if (s.time() != time_) {
+                time_ = s.time();
+                delta_ = 0;
+            } else {
+                ++delta_;
+            }
+            for (uint32_t i = 0; i < ports_.size(); ++i)
+                if (ports_[i].port->changed()) record(i);
+        });
+    }
+
+    ~TraceRecorder() { close(); }
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    bool ok() const { return out_ != nullptr; }
+    uint64_t records() const { return records_; }
+
+    void flush() {
+        if (!out_) return;
+        if (!buf_.empty() && std::fwrite(buf_.data(), 1, buf_.size(), out_) != buf_.size())
+            std::cerr << "[Veroutines] Trace write failed\n";
+        buf_.clear();
+        std::fflush(out_);
+    }
+
+    // Stop recording and close the file; later commits are ignored
+    void close() {
+        flush();
+        if (out_) std::fclose(out_);
+        out_ = nullptr;
+    }
+
+private:
+    void append(const void* p, size_t n) {
+        const auto* b = static_cast<const unsigned char*>(p);
+        buf_.insert(buf_.end(), b, b + n);
+    }
+
+    void record(uint32_t i) {
+        if (!out_) return;
+        const auto& p = ports_[i];
+        TraceRecord r{time_, delta_, i, p.bytes, 0};
+        append(&r, sizeof(r));
+        size_t at = buf_.size();
+        buf_.resize(at + trace_pad(p.bytes));
+        p.get(p.port, buf_.data() + at);
+        ++records_;
+        if (buf_.size() >= kFlushBytes) flush();
+    }
+};
+
+// -----------------------------------------------------------------------------
+// TraceReplay - Drive input ports from a memory-mapped trace
+//
+// Nothing is parsed up front. One timed event is pending at a time: at
+// each record time it writes the records of the timestep's first delta,
+// then schedules itself for the next time. Those writes land in the
+// timed-event phase, before the first delta. Each later delta of the
+// same timestep is replayed one delta after the previous one, by a
+// process that re-arms itself through an internal signal, so zero-time
+// pulses survive. Pages already replayed are released every `window`
+// bytes, so resident memory stays bounded for long traces. Records
+// stamped before the current time are replayed immediately.
+// -----------------------------------------------------------------------------
+
+class TraceReplay {
+    Scheduler& sched_;
+    std::vector<detail::TracePort> ports_;
+    Signal<uint32_t>* next_delta_;
+    const unsigned char* map_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;            // Next record
+    size_t released_ = 0;       // Mapping below this offset has been dropped
+    size_t window_;
+    uint64_t records_ = 0;
+    bool ok_ = false;
+
+public:
+    template<typename... Ts>
+    TraceReplay(Scheduler& s, const char* path, InputPort<Ts>*... ports)
+        : TraceReplay(s, path, size_t(4) << 20, ports...) {}
+
+    template<typename... Ts>
+    TraceReplay(Scheduler& s, const char* path, size_t window, InputPort<Ts>*... ports)
+        : sched_(s), ports_{detail::trace_port(ports)...}, next_delta_(s.signal<uint32_t>()),
+          window_(window) {
+        if (!map(path) || !check(path)) return;
+        ok_ = true;
+        s.process({next_delta_}, [this](Scheduler&) { pump(); });
+        if (more()) s.schedule_at(next_time(), [this] { pump(); });
+    }
+
+    ~TraceReplay() {
+        if (map_) ::munmap(const_cast<unsigned char*>(map_), size_);
+    }
+
+    TraceReplay(const TraceReplay&) = delete;
+    TraceReplay& operator=(const TraceReplay&) = delete;
+
+    bool ok() const { return ok_; }
+    bool done() const { return !ok_ || pos_ >= size_; }
+    uint64_t records() const { return records_; }
+
+private:
+    bool map(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "[Veroutines] Cannot open trace " << path << "\n";
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(TraceHeader))) {
+            std::cerr << "[Veroutines] Trace " << path << " is truncated\n";
+            ::close(fd);
+            return false;
+        }
+        size_ = size_t(st.st_size);
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            std::cerr << "[Veroutines] Cannot map trace " << path << "\n";
+            size_ = 0;
+            return false;
+        }
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        map_ = static_cast<const unsigned char*>(p);
+        return true;
+    }
+
+    bool check(const char* path) {
+        TraceHeader h;
+        std::memcpy(&h, map_, sizeof(h));
+        if (std::memcmp(h.magic, kTraceMagic, sizeof(h.magic)) != 0) {
+            std::cerr << "[Veroutines] " << path << " is not a trace\n";
+            return false;
+        }
+        pos_ = trace_pad(sizeof(h) + h.ports * sizeof(uint32_t));
+        if (h.ports != ports_.size() || pos_ > size_) {
+            std::cerr << "[Veroutines] Trace " << path << " has " << h.ports << " ports, "
+                      << ports_.size() << " given\n";
+            return false;
+        }
+        for (uint32_t i = 0; i < h.ports; ++i) {
+            uint32_t bytes;
+            std::memcpy(&bytes, map_ + sizeof(h) + i * sizeof(uint32_t), sizeof(bytes));
+            if (bytes != ports_[i].bytes) {
+                std::cerr << "[Veroutines] Trace " << path << " port " << i << " is "
+                          << bytes << " bytes, port given is " << ports_[i].bytes << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool more() const { return pos_ + sizeof(TraceRecord) <= size_; }
+
+    TraceRecord next_record() const {
+        TraceRecord r;
+        std::memcpy(&r, map_ + pos_, sizeof(r));
+        return r;
+    }
+
+    uint64_t next_time() const { return next_record().time; }
+
+    // Write the records of one recorded delta, then arm the next one:
+    // in the next delta if it is due now, else as a timed event
+    void pump() {
+        const TraceRecord first = next_record();
+        while (more()) {
+            TraceRecord r = next_record();
+            if (r.time != first.time || r.delta != first.delta) break;
+            size_t next = pos_ + sizeof(r) + trace_pad(r.bytes);
+            if (r.port >= ports_.size() || r.bytes != ports_[r.port].bytes || next > size_) {
+                std::cerr << "[Veroutines] Corrupt trace record at offset " << pos_ << "\n";
+                pos_ = size_;
+                return;
+            }
+            ports_[r.port].put(ports_[r.port].port, map_ + pos_ + sizeof(r));
+            pos_ = next;
+            ++records_;
+        }
+        release();
+        if (!more()) pos_ = size_;
+        else if (next_time() <= sched_.time()) next_delta_->write(next_delta_->val() + 1);
+        else sched_.schedule_at(next_time(), [this] { pump(); });
+    }
+
+    // Drop whole pages behind the read position once a window has passed
+    void release() {
+        static const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+        size_t upto = pos_ / page * page;
+        if (upto < released_ + window_) return;
+        ::madvise(const_cast<unsigned char*>(map_) + released_, upto - released_, MADV_DONTNEED);
+        released_ = upto;
+    }
+};
+
+} // namespace Veroutines
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// Scoreboard<T, KeyOf> - Streaming expected/actual comparison
+//
+// The stimulus side calls expect() per transaction; the DUT side is either
+// wired to output ports (sampled on the rising clock edge, handshake as in
+// AxiStreamSink) or fed through observe(). Each actual item is compared as
+// it arrives and then forgotten, so memory is the outstanding window only:
+// a fixed pool of `capacity` entries, allocated once.
+//
+// InOrder compares against the oldest outstanding item. OutOfOrder looks
+// the item up by KeyOf(item) (a transaction ID) in a fixed hash index and
+// compares against the oldest outstanding item with that key.
+//
+// When the pool is full, expect() returns false and ready() goes low, so
+// a source can hold off (process sensitive to ready(), or check full())
+// instead of the queue growing while the DUT stalls.
+// -----------------------------------------------------------------------------
+
+template<typename T, typename KeyOf = std::identity>
+class Scoreboard {
+public:
+    using Key = std::decay_t<std::invoke_result_t<KeyOf, const T&>>;
+
+    enum class Order : uint8_t { InOrder, OutOfOrder };
+
+    struct Ports {
+        OutputPort<CData>* valid;
+        OutputPort<T>* data;
+        InputPort<CData>* ready = nullptr;   // Optional, handshake qualifier
+        InputPort<CData>* rst = nullptr;     // Optional, active high
+    };
+
+    struct Report {
+        enum Kind : uint8_t {
+            Mismatch,       // Compared against an expected item and differed
+            Unexpected,     // Nothing outstanding (with this key)
+            Missing         // Still outstanding at finish()
+        };
+        Kind kind;
+        uint64_t time;              // Time of the actual item (or of finish())
+        uint64_t expected_time;     // Time the expected item was queued
+        const T* expected;          // Null for Unexpected
+        const T* actual;            // Null for Missing
+    };
+
+    using ReportCallback = std::function<void(const Report&)>;
+
+    struct Config {
+        Order order = Order::InOrder;
+        size_t capacity = 1024;             // Outstanding expected items
+        size_t max_reports = 16;            // Printed when there is no callback
+        const char* name = "scoreboard";
+    };
+
+private:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Entry {
+        T value;
+        uint64_t time;
+        uint32_t next;          // Ring: unused. OutOfOrder: next in bucket chain / free list
+    };
+
+    Scheduler& sched_;
+    Config cfg_;
+    KeyOf key_;
+    ReportCallback report_;
+    Ports p_{};
+    Signal<CData>* ready_;
+
+    std::vector<Entry> pool_;
+    size_t head_ = 0;                        // InOrder: oldest entry
+    size_t count_ = 0;
+
+    std::vector<uint32_t> buckets_;          // OutOfOrder: chain heads, oldest first
+    uint32_t free_ = None;
+
+    uint64_t expected_ = 0;
+    uint64_t matched_ = 0;
+    uint64_t mismatched_ = 0;
+    uint64_t unexpected_ = 0;
+    uint64_t missing_ = 0;
+    uint64_t reported_ = 0;
+
+public:
+    Scoreboard(Scheduler& s, Config cfg = {}, KeyOf key = {}, ReportCallback cb = nullptr)
+        : sched_(s), cfg_(cfg), key_(std::move(key)), report_(std::move(cb)),
+          ready_(s.signal<CData>(1)), pool_(cfg.capacity) {
+        if (cfg_.order == Order::OutOfOrder) {
+            if constexpr (!hashable) {
+                std::cerr << "[Veroutines] " << cfg_.name
+                          << ": out-of-order needs a hashable key; comparing in order\n";
+                cfg_.order = Order::InOrder;
+            } else {
+                size_t n = 1;
+                while (n < 2 * cfg_.capacity) n <<= 1;
+                buckets_.assign(n, None);
+                for (size_t i = pool_.size(); i-- > 0;) {
+                    pool_[i].next = free_;
+                    free_ = uint32_t(i);
+                }
+            }
+        }
+    }
+
+    // Wired to a valid/data interface, checked on the rising edge of clk
+    Scoreboard(Scheduler& s, Observable* clk, Ports p, Config cfg = {}, KeyOf key = {},
+               ReportCallback cb = nullptr)
+        : Scoreboard(s, cfg, std::move(key), std::move(cb)) {
+        p_ = p;
+        p_.valid->sample_eagerly();
+        p_.data->sample_eagerly();
+        s.process({posedge(clk)}, [this](Scheduler&) { on_clock(); });
+    }
+
+    Scoreboard(const Scoreboard&) = delete;
+    Scoreboard& operator=(const Scoreboard&) = delete;
+
+    // Queue an expected item; false (nothing queued) if the pool is full
+    bool expect(const T& item) {
+        if (count_ == pool_.size()) return false;
+        if (cfg_.order == Order::InOrder) {
+            Entry& e = pool_[(head_ + count_) % pool_.size()];
+            e.value = item;
+            e.time = sched_.time();
+        } else {
+            insert(item);
+        }
+        ++count_;
+        ++expected_;
+        update_ready();
+        return true;
+    }
+
+    // Compare one actual item
+    void observe(const T& item) {
+        if (cfg_.order == Order::InOrder) observe_in_order(item);
+        else observe_out_of_order(item);
+        update_ready();
+    }
+
+    // Report everything still outstanding as Missing; true if the run was clean
+    bool finish() {
+        if (cfg_.order == Order::InOrder) {
+            for (size_t i = 0; i < count_; ++i) {
+                const Entry& e = pool_[(head_ + i) % pool_.size()];
+                emit({Report::Missing, sched_.time(), e.time, &e.value, nullptr});
+            }
+            head_ = 0;
+        } else {
+            for (auto& b : buckets_) {
+                for (uint32_t i = b; i != None;) {
+                    Entry& e = pool_[i];
+                    uint32_t next = e.next;
+                    emit({Report::Missing, sched_.time(), e.time, &e.value, nullptr});
+                    e.next = free_;
+                    free_ = i;
+                    i = next;
+                }
+                b = None;
+            }
+        }
+        missing_ += count_;
+        count_ = 0;
+        update_ready();
+        return passed();
+    }
+
+    // High while expect() would accept an item
+    Signal<CData>* ready() const { return ready_; }
+
+    bool full() const { return count_ == pool_.size(); }
+    size_t outstanding() const { return count_; }
+    bool passed() const { return mismatched_ == 0 && unexpected_ == 0 && missing_ == 0; }
+
+    uint64_t expected() const { return expected_; }
+    uint64_t matched() const { return matched_; }
+    uint64_t mismatched() const { return mismatched_; }
+    uint64_t unexpected() const { return unexpected_; }
+    uint64_t missing() const { return missing_; }
+
+    void print(std::ostream& os) const {
+        os << "[Veroutines] " << cfg_.name << ": " << matched_ << "/" << expected_ << " matched, "
+           << mismatched_ << " mismatched, " << unexpected_ << " unexpected, "
+           << missing_ << " missing, " << count_ << " outstanding\n";
+    }
+
+private:
+    static constexpr bool hashable = requires(const Key& k) { std::hash<Key>{}(k); };
+
+    void on_clock() {
+        if (p_.rst && p_.rst->val()) return;
+        if (!p_.valid->before() || (p_.ready && !p_.ready->val())) return;
+        observe(p_.data->before());
+    }
+
+    void observe_in_order(const T& item) {
+        if (count_ == 0) {
+            ++unexpected_;
+            emit({Report::Unexpected, sched_.time(), 0, nullptr, &item});
+            return;
+        }
+        const Entry& e = pool_[head_];
+        if (differs(e.value, item)) {
+            ++mismatched_;
+            emit({Report::Mismatch, sched_.time(), e.time, &e.value, &item});
+        } else {
+            ++matched_;
+        }
+        head_ = (head_ + 1) % pool_.size();
+        --count_;
+    }
+
+    void observe_out_of_order(const T& item) {
+        if constexpr (hashable) {
+            const Key k = key_(item);
+            uint32_t* link = &buckets_[bucket(k)];
+            while (*link != None && !(key_(pool_[*link].value) == k)) link = &pool_[*link].next;
+            if (*link == None) {
+                ++unexpected_;
+                emit({Report::Unexpected, sched_.time(), 0, nullptr, &item});
+                return;
+            }
+            uint32_t i = *link;
+            Entry& e = pool_[i];
+            if (differs(e.value, item)) {
+                ++mismatched_;
+                emit({Report::Mismatch, sched_.time(), e.time, &e.value, &item});
+            } else {
+                ++matched_;
+            }
+            *link = e.next;
+            e.next = free_;
+            free_ = i;
+            --count_;
+        }
+    }
+
+    // Append to the key's chain, so equal keys match oldest first
+    void insert(const T& item) {
+        if constexpr (hashable) {
+            uint32_t i = free_;
+            Entry& e = pool_[i];
+            free_ = e.next;
+            e.value = item;
+            e.time = sched_.time();
+            e.next = None;
+            uint32_t* link = &buckets_[bucket(key_(item))];
+            while (*link != None) link = &pool_[*link].next;
+            *link = i;
+        }
+    }
+
+    size_t bucket(const Key& k) const {
+        if constexpr (hashable) {
+            // Spread sequential IDs before masking
+            uint64_t h = uint64_t(std::hash<Key>{}(k)) * 0x9e3779b97f4a7c15ull;
+            return size_t(h >> 32) & (buckets_.size() - 1);
+        } else {
+            return 0;
+        }
+    }
+
+    void update_ready() { ready_->write(count_ < pool_.size()); }
+
+    void emit(const Report& r) {
+        if (report_) {
+            report_(r);
+            return;
+        }
+        if (reported_++ >= cfg_.max_reports) return;
+        static constexpr const char* kinds[] = {"mismatch", "unexpected", "missing"};
+        std::cerr << "[Veroutines] " << cfg_.name << " " << kinds[r.kind] << " at t=" << r.time;
+        if (r.expected) std::cerr << " (expected since t=" << r.expected_time << ")";
+        if constexpr (std::is_arithmetic_v<T>) {
+            if (r.expected) std::cerr << " expected " << +*r.expected;
+            if (r.actual) std::cerr << " got " << +*r.actual;
+        }
+        std::cerr << "\n";
+        if (reported_ == cfg_.max_reports)
+            std::cerr << "[Veroutines] " << cfg_.name << ": further reports suppressed\n";
+    }
+};
+
+} // namespace Veroutines
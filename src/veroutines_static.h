@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "veroutines.h"
+
+namespace Veroutines {
+
+// -----------------------------------------------------------------------------
+// StaticScheduler - Fixed-topology kernel configured at compile time
+//
+// Same 5-phase loop and the same InputPort/OutputPort/Signal classes as
+// Scheduler, but the port set and every process's sensitivity list are
+// template parameters. Commit, sample and react unroll into straight-line
+// code over a tuple of ports: no dirty queues, no dependents vectors, no
+// virtual calls (port methods are called qualified) and no std::function.
+// Processes run in list order, which is their PID order in Scheduler.
+//
+//   using Clk    = Static::In<VR_PORT(clk)>;
+//   using Tready = Static::Out<VR_PORT(s_tready)>;
+//   struct Count : Static::Sig<uint32_t> {};
+//
+//   struct OnClk {
+//       void operator()(auto& s) {
+//           auto& n = port<Count>(s);
+//           if (port<Tready>(s).val()) n.write(n.val() + 1);
+//       }
+//   };
+//
+//   StaticScheduler<Vaxibox,
+//                   Static::Ports<Clk, Tready, Count>,
+//                   Static::Processes<Static::Proc<OnClk, Static::Pos<Clk>>>> sched(ctx, top);
+//   sched.clock<Clk>(10, 0.5, 5);
+//   sched.run(tfp, 500);
+//
+// Callbacks take the scheduler as `auto&`, since its type names them. Timed
+// events use Action like Scheduler; coroutines, multiple models and
+// parallel phases are dynamic-Scheduler only.
+// -----------------------------------------------------------------------------
+
+// Captureless accessor for a port of the top model, usable as a tag argument
+#define VR_PORT(member) [](auto& top_) -> auto& { return top_.member; }
+
+namespace Static {
+
+struct InputTag {};
+struct OutputTag {};
+struct SignalTag {};
+
+// DUT input/output bound through an accessor (Verilator ports are
+// references, so a pointer-to-member cannot name them)
+template<auto Get>
+struct In : InputTag {
+    static constexpr auto get = Get;
+};
+
+template<auto Get>
+struct Out : OutputTag {
+    static constexpr auto get = Get;
+};
+
+// Testbench signal; derive a named tag from it, and hide initial() to
+// start from something other than T{}
+template<typename T>
+struct Sig : SignalTag {
+    using type = T;
+    static T initial() { return T{}; }
+};
+
+// Sensitivity entries; a bare tag means any change
+template<typename Tag> struct Pos {};
+template<typename Tag> struct Neg {};
+
+// Fn is called as fn(sched) when any of Sens fires; with no Sens it runs
+// every delta, like Scheduler::always()
+template<typename Fn, typename... Sens>
+struct Proc {
+    using fn = Fn;
+};
+
+template<typename... Tags> struct Ports {};
+template<typename... Procs> struct Processes {};
+
+// Storage for one tag: the same port classes Scheduler hands out
+template<typename Top, typename Tag, typename = void>
+struct Slot;
+
+template<typename Top, typename Tag>
+using port_value_t = std::remove_cvref_t<decltype(Tag::get(std::declval<Top&>()))>;
+
+template<typename Top, typename Tag>
+struct Slot<Top, Tag, std::enable_if_t<std::is_base_of_v<InputTag, Tag>>> {
+    using Port = InputPort<port_value_t<Top, Tag>>;
+    Port port;
+    explicit Slot(Top& top) : port(&Tag::get(top)) {}
+};
+
+template<typename Top, typename Tag>
+struct Slot<Top, Tag, std::enable_if_t<std::is_base_of_v<OutputTag, Tag>>> {
+    using Port = OutputPort<port_value_t<Top, Tag>>;
+    OutputBank<port_value_t<Top, Tag>> bank;
+    Port port;
+    explicit Slot(Top& top) : port(&bank, &Tag::get(top)) {}
+};
+
+template<typename Top, typename Tag>
+struct Slot<Top, Tag, std::enable_if_t<std::is_base_of_v<SignalTag, Tag>>> {
+    using Port = Signal<typename Tag::type>;
+    Port port;
+    explicit Slot(Top&) : port(Tag::initial()) {}
+};
+
+template<typename Tag, typename... Tags>
+constexpr size_t index_of() {
+    constexpr bool match[] = {std::is_same_v<Tag, Tags>...};
+    for (size_t i = 0; i < sizeof...(Tags); ++i)
+        if (match[i]) return i;
+    return sizeof...(Tags);
+}
+
+} // namespace Static
+
+template<typename TopModel, typename PortList, typename ProcessList>
+class StaticScheduler;
+
+template<typename TopModel, typename... Tags, typename... Procs>
+class StaticScheduler<TopModel, Static::Ports<Tags...>, Static::Processes<Procs...>> {
+    template<typename Tag>
+    static constexpr size_t index = Static::index_of<Tag, Tags...>();
+
+    template<typename Tag>
+    static constexpr bool is_input = std::is_base_of_v<Static::InputTag, Tag>;
+    template<typename Tag>
+    static constexpr bool is_output = std::is_base_of_v<Static::OutputTag, Tag>;
+
+    VerilatedContext* ctx_;
+    TopModel* top_;
+    std::tuple<Static::Slot<TopModel, Tags>...> slots_;
+    std::tuple<typename Procs::fn...> fns_;
+
+    TimingWheel time_events_;
+
+    struct Clock {
+        Observable* port;
+        void (*drive)(Observable*, bool);   // Writes the level as the port's type
+        uint64_t high;    // Ticks spent high
+        uint64_t low;     // Ticks spent low
+        uint64_t next;    // Time of next edge
+        bool level;       // Level driven at next edge
+    };
+    std::vector<Clock> clocks_;
+    uint64_t next_clock_ = UINT64_MAX;
+
+    int max_deltas_ = 1000;
+    LoopPolicy loop_policy_ = LoopPolicy::Abort;
+    bool initialized_ = false;
+
+    uint64_t current_time_ = 0;
+    uint64_t timesteps_ = 0;
+    uint64_t deltas_ = 0;
+
+    template<typename Tag>
+    static TopModel& top_for(TopModel& top) { return top; }
+
+public:
+    StaticScheduler(VerilatedContext* ctx, TopModel* top)
+        : ctx_(ctx), top_(top), slots_(top_for<Tags>(*top)...) {}
+
+    // Processes with state: pass the callbacks in list order
+    StaticScheduler(VerilatedContext* ctx, TopModel* top, typename Procs::fn... fns)
+        requires (sizeof...(Procs) > 0)
+        : ctx_(ctx), top_(top), slots_(top_for<Tags>(*top)...), fns_(std::move(fns)...) {}
+
+    StaticScheduler(const StaticScheduler&) = delete;
+    StaticScheduler& operator=(const StaticScheduler&) = delete;
+
+    // The port behind a tag: InputPort, OutputPort or Signal
+    template<typename Tag>
+    auto& port() {
+        static_assert(index<Tag> < sizeof...(Tags), "tag is not in the Ports list");
+        return std::get<index<Tag>>(slots_).port;
+    }
+
+    // Callback object of the process whose Fn is `Fn`
+    template<typename Fn>
+    Fn& process() { return std::get<Fn>(fns_); }
+
+    uint64_t time() const { return current_time_; }
+    uint64_t timesteps() const { return timesteps_; }
+    uint64_t deltas() const { return deltas_; }
+
+    TimerId schedule_after(uint64_t delay, Action action) {
+        return time_events_.push(current_time_ + delay, std::move(action));
+    }
+
+    TimerId schedule_at(uint64_t t, Action action) {
+        return time_events_.push(t, std::move(action));
+    }
+
+    bool cancel(TimerId id) { return time_events_.cancel(id); }
+
+    // Same generator as Scheduler::clock() on a narrow input tag
+    template<typename Tag>
+    void clock(uint64_t period, double duty = 0.5, uint64_t phase = 0) {
+        static_assert(is_input<Tag>, "clock() drives an input port");
+        using T = Static::port_value_t<TopModel, Tag>;
+        static_assert(!is_wide_v<T>, "clock() drives a narrow port");
+        uint64_t high = uint64_t(double(period) * duty + 0.5);
+        high = std::clamp<uint64_t>(high, 1, period > 1 ? period - 1 : 1);
+        uint64_t low = period > high ? period - high : 1;
+
+        auto drive = [](Observable* o, bool level) {
+            static_cast<InputPort<T>*>(o)->write(level ? T(1) : T(0));
+        };
+        auto& p = port<Tag>();
+        p.write(T(0));
+        clocks_.push_back({&p, drive, high, low, current_time_ + phase, true});
+        next_clock_ = std::min(next_clock_, current_time_ + phase);
+    }
+
+    // Abort or SkipTimestep; there is no per-port history to hand a callback
+    void delta_limit(int max, LoopPolicy policy = LoopPolicy::Abort) {
+        max_deltas_ = std::max(max, 1);
+        if (policy == LoopPolicy::Callback) {
+            std::cerr << "[Veroutines] StaticScheduler has no loop callback; aborting on loops\n";
+            policy = LoopPolicy::Abort;
+        }
+        loop_policy_ = policy;
+    }
+
+    // --- Main Loop ---
+
+    template<typename Trace = NoTrace>
+    void run(Trace* tfp = nullptr, uint64_t timeout = UINT64_MAX) {
+        if (tfp) tfp->dump(0);
+
+        while (!ctx_->gotFinish() && current_time_ < timeout) {
+            uint64_t t_next = std::min(time_events_.next_time(), next_clock_);
+            if (top_->eventsPending()) t_next = std::min(t_next, top_->nextTimeSlot());
+            if (t_next == UINT64_MAX) break;
+
+            ctx_->time(t_next);
+            current_time_ = t_next;
+            time_events_.advance(t_next);
+            ++timesteps_;
+
+            if (next_clock_ == t_next)
+                fire_clocks();
+
+            for (Action ev; time_events_.pop(ev);)
+                ev();
+
+            int delta = 0;
+            while (true) {
+                // PHASE 1: COMMIT
+                bool committed = commit_all(std::index_sequence_for<Tags...>{});
+
+                // PHASE 2: EVAL
+                bool evaluated = !initialized_ || committed ||
+                                 (top_->eventsPending() && top_->nextTimeSlot() <= t_next);
+                initialized_ = true;
+                if (evaluated) top_->eval();
+
+                // PHASE 3: SAMPLE
+                sample_all(evaluated, std::index_sequence_for<Tags...>{});
+
+                // PHASE 4: REACT
+                react(std::index_sequence_for<Procs...>{});
+
+                // PHASE 5: CONVERGENCE
+                ++deltas_;
+                if (!any_dirty(std::index_sequence_for<Tags...>{}))
+                    break;
+
+                if (++delta > max_deltas_) {
+                    if (!delta_limit_hit(delta - 1)) return;
+                    break;
+                }
+            }
+
+            if (tfp) tfp->dump(t_next);
+        }
+    }
+
+private:
+    // Qualified calls bind statically; the slot types are exact
+    template<typename P> static bool commit_port(P& p) { return p.P::commit(); }
+    template<typename P> static void settle_port(P& p) { p.P::settle(); }
+    template<typename P> static bool changed_port(const P& p) { return p.P::changed(); }
+
+    template<size_t... I>
+    bool commit_all(std::index_sequence<I...>) {
+        bool inputs = false;
+        auto one = [&]<size_t K>(std::integral_constant<size_t, K>) {
+            using Tag = std::tuple_element_t<K, std::tuple<Tags...>>;
+            if constexpr (!is_output<Tag>) {
+                auto& p = std::get<K>(slots_).port;
+                settle_port(p);
+                if (p.dirty()) {
+                    bool c = commit_port(p);
+                    if constexpr (is_input<Tag>) inputs |= c;
+                }
+            }
+        };
+        (one(std::integral_constant<size_t, I>{}), ...);
+        return inputs;
+    }
+
+    template<size_t... I>
+    void sample_all(bool evaluated, std::index_sequence<I...>) {
+        auto one = [&]<size_t K>(std::integral_constant<size_t, K>) {
+            using Tag = std::tuple_element_t<K, std::tuple<Tags...>>;
+            if constexpr (is_output<Tag>) {
+                auto& bank = std::get<K>(slots_).bank;
+                if (evaluated || bank.pending()) bank.sample_each([](Observable*) {});
+            }
+        };
+        (one(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    template<size_t... I>
+    bool any_dirty(std::index_sequence<I...>) const {
+        return (std::get<I>(slots_).port.dirty() || ...);
+    }
+
+    template<typename Tag>
+    bool edge_fires(Static::Pos<Tag>*) { return port<Tag>().posedge(); }
+    template<typename Tag>
+    bool edge_fires(Static::Neg<Tag>*) { return port<Tag>().negedge(); }
+    template<typename Tag>
+    bool edge_fires(Tag*) { return changed_port(port<Tag>()); }
+
+    template<typename Fn, typename... Sens>
+    bool triggered(Static::Proc<Fn, Sens...>*) {
+        if constexpr (sizeof...(Sens) == 0) return true;
+        else return (edge_fires(static_cast<Sens*>(nullptr)) || ...);
+    }
+
+    template<size_t... J>
+    void react(std::index_sequence<J...>) {
+        // Writes only stage, so earlier callbacks cannot change later triggers
+        ((triggered(static_cast<Procs*>(nullptr)) ? std::get<J>(fns_)(*this) : void()), ...);
+    }
+
+    void fire_clocks() {
+        uint64_t next = UINT64_MAX;
+        for (auto& c : clocks_) {
+            if (c.next == current_time_) {
+                c.drive(c.port, c.level);
+                c.next += c.level ? c.high : c.low;
+                c.level = !c.level;
+            }
+            next = std::min(next, c.next);
+        }
+        next_clock_ = next;
+    }
+
+    bool delta_limit_hit(int deltas) {
+        LoopReport r{current_time_, deltas, 1, {}};
+        size_t i = 0;
+        auto add = [&](Observable& o) {
+            if (o.dirty()) r.toggled.push_back({&o, "port" + std::to_string(i), 1, o.last_writer()});
+            ++i;
+        };
+        std::apply([&](auto&... s) { (add(s.port), ...); }, slots_);
+        r.print(std::cerr);
+        if (loop_policy_ != LoopPolicy::SkipTimestep) return false;
+
+        // Writes still pending belong to the oscillation; drop them
+        std::apply([](auto&... s) { ((s.port.dirty_ = false), ...); }, slots_);
+        return true;
+    }
+};
+
+// Port behind a tag, for callbacks that take the scheduler as `auto&`
+template<typename Tag, typename TopModel, typename PortList, typename ProcessList>
+auto& port(StaticScheduler<TopModel, PortList, ProcessList>& s) {
+    return s.template port<Tag>();
+}
+
+} // namespace Veroutines